@@ -11,6 +11,7 @@ class Config {
 
   public:
     explicit Config(const std::string& filename);
+    [[nodiscard]] bool has(const std::string& key) const;
     [[nodiscard]] const std::string& get(const std::string& key) const;
     ~Config();
 };
@@ -2,8 +2,13 @@
 #define MY_GRAPH_ATTRIBUTES_H
 
 #include <any>
+#include <array>
+#include <span>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "core/graph/node_index_map.hpp"
 #include "core/utils.hpp"
 
 enum class Attribute {
@@ -15,11 +20,28 @@ enum class Attribute {
     // NODES_STRING_LABEL,
     // EDGES_STRING_LABEL,
     // NODES_ANY_LABEL,
-    EDGES_ANY_LABEL
+    EDGES_ANY_LABEL,
+    EDGES_INT_PAIR_LABEL
 };
 
+// EDGES_INT_PAIR_LABEL is the last attribute
+constexpr size_t NUMBER_OF_ATTRIBUTES = static_cast<size_t>(Attribute::EDGES_INT_PAIR_LABEL) + 1;
+
+// every attribute is a column with a presence flag per entry, a node (edge) gets the next slot of
+// the node (edge) columns the first time one of its attributes is set, so columns grow with the
+// number of ids used and not with the largest one
 class GraphAttributes {
-    std::unordered_map<Attribute, std::unordered_map<int, std::any>> mattribute_to_node;
+    std::array<bool, NUMBER_OF_ATTRIBUTES> m_has_attribute{};
+    NodeIndexMap m_nodes_slots;
+    NodeIndexMap m_edges_slots;
+    std::vector<Color> m_nodes_color;
+    std::vector<bool> m_has_node_color;
+    std::vector<int> m_positions_x;
+    std::vector<int> m_positions_y;
+    std::vector<bool> m_has_node_position;
+    std::vector<std::pair<int, int>> m_edges_int_pair_label;
+    std::vector<bool> m_has_edge_int_pair_label;
+    std::unordered_map<int, std::any> m_edges_any_label;
     bool has_attribute_by_id(Attribute attribute, int id) const;
 
   public:
@@ -33,6 +55,8 @@ class GraphAttributes {
     // edge label
     void set_edge_any_label(int edge_id, const std::any& label);
     const std::any& get_edge_any_label(int edge_id) const;
+    void set_edge_int_pair_label(int edge_id, std::pair<int, int> label);
+    std::pair<int, int> get_edge_int_pair_label(int edge_id) const;
     void remove_nodes_attribute(int node_id);
     // position
     void set_position(int node_id, int x, int y);
@@ -43,6 +67,12 @@ class GraphAttributes {
     int get_position_y(int node_id) const;
     bool has_position(int node_id) const;
     void remove_position(int node_id);
+    // slot of the node in the bulk columns, NodeIndexMap::NO_INDEX if it has no attribute
+    size_t get_node_slot(const int node_id) const { return m_nodes_slots.find_index(node_id); }
+    // bulk access, indexed by slot, only entries of nodes having the attribute are meaningful
+    std::span<const Color> get_nodes_color() const { return m_nodes_color; }
+    std::span<const int> get_positions_x() const { return m_positions_x; }
+    std::span<const int> get_positions_y() const { return m_positions_y; }
 };
 
-#endif
\ No newline at end of file
+#endif
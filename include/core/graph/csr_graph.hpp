@@ -0,0 +1,56 @@
+#ifndef MY_CSR_GRAPH_H
+#define MY_CSR_GRAPH_H
+
+#include <span>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+#include "core/graph/node_index_map.hpp"
+
+struct CsrEdge {
+    int id;
+    size_t from_index;
+    size_t to_index;
+};
+
+// immutable compressed-sparse-row snapshot of a graph, nodes are addressed by a dense
+// index in [0, size()), the order of nodes and of neighbors is the same of the source graph
+class CsrGraph {
+    bool m_is_directed;
+    // sparse ids (much larger than the number of nodes) do not grow the table of the indices
+    NodeIndexMap m_node_index;
+    std::vector<size_t> m_offsets;
+    std::vector<size_t> m_neighbors;
+    std::vector<int> m_edges_ids;
+    std::vector<CsrEdge> m_edges;
+    void build(const Graph& graph);
+
+  public:
+    static constexpr size_t NO_INDEX = NodeIndexMap::NO_INDEX;
+    explicit CsrGraph(const UndirectedSimpleGraph& graph);
+    explicit CsrGraph(const DirectedSimpleGraph& graph);
+    [[nodiscard]] bool is_directed() const { return m_is_directed; }
+    [[nodiscard]] size_t size() const { return m_node_index.size(); }
+    [[nodiscard]] size_t get_number_of_edges() const { return m_edges.size(); }
+    [[nodiscard]] bool has_node(const int node_id) const { return m_node_index.has_node(node_id); }
+    [[nodiscard]] size_t get_index(int node_id) const;
+    [[nodiscard]] int get_node_id(const size_t index) const {
+        return m_node_index.get_node_id(index);
+    }
+    [[nodiscard]] const std::vector<int>& get_nodes_ids() const {
+        return m_node_index.get_nodes_ids();
+    }
+    [[nodiscard]] std::span<const size_t> get_neighbors(const size_t index) const {
+        return {m_neighbors.data() + m_offsets[index], m_offsets[index + 1] - m_offsets[index]};
+    }
+    [[nodiscard]] std::span<const int> get_edges_ids(const size_t index) const {
+        return {m_edges_ids.data() + m_offsets[index], m_offsets[index + 1] - m_offsets[index]};
+    }
+    [[nodiscard]] size_t get_degree(const size_t index) const {
+        return m_offsets[index + 1] - m_offsets[index];
+    }
+    // every edge once, with the orientation it has in the source graph
+    [[nodiscard]] std::span<const CsrEdge> get_edges() const { return m_edges; }
+};
+
+#endif
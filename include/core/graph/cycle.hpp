@@ -7,8 +7,15 @@
 
 #include "core/utils.hpp"
 
+// the linked ring makes inserting/removing nodes O(1), the vector keeps positions always ready
+#ifdef DOMUS_LINKED_CYCLES
+using CycleNodesSequence = LinkedCircularSequence<int>;
+#else
+using CycleNodesSequence = CircularSequence<int>;
+#endif
+
 class Cycle {
-    CircularSequence<int> m_nodes_ids;
+    CycleNodesSequence m_nodes_ids;
     size_t next_index(size_t index) const;
     void reverse();
 
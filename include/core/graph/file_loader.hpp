@@ -11,6 +11,12 @@ std::unique_ptr<UndirectedSimpleGraph> load_graph_from_txt_file(const std::strin
 
 void load_graph_from_txt_file(const std::string& filename, UndirectedSimpleGraph& graph);
 
+// same format, semantics and errors as load_graph_from_txt_file, but the file is mapped in memory
+// and scanned twice: once to count the nodes and edges (and reserve them), once to build the graph
+std::unique_ptr<UndirectedSimpleGraph> load_graph_from_mapped_txt_file(const std::string& filename);
+
+void load_graph_from_mapped_txt_file(const std::string& filename, UndirectedSimpleGraph& graph);
+
 void save_graph_to_file(const UndirectedSimpleGraph& graph, const std::string& filename);
 
 void save_graph_to_graphml_file(const UndirectedSimpleGraph& graph,
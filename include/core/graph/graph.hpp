@@ -2,10 +2,12 @@
 #define MY_GRAPH_H
 
 #include <memory>
+#include <ranges>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "core/graph/node_index_map.hpp"
 #include "core/utils.hpp"
 
 using GraphEdgeHashSet = std::unordered_set<std::pair<int, int>, int_pair_hash>;
@@ -16,6 +18,12 @@ using GraphEdgeHashMap = std::unordered_map<std::pair<int, int>, T, int_pair_has
 class GraphNode;
 class Graph;
 
+// neighbor of a node as seen from that node, together with the id of the edge reaching it
+struct GraphNeighbor {
+    int id;
+    int edge_id;
+};
+
 struct GraphEdge {
   private:
     int m_id;
@@ -42,20 +50,40 @@ class Graph {
     std::unordered_map<int, std::unique_ptr<GraphEdge>> m_edgeid_to_edge_map;
     std::unordered_map<int, std::unordered_set<int>> m_nodeid_to_incident_edgeids;
     GraphEdgeHashMap<std::unordered_set<int>> m_edge_to_edgeids;
+    NodeIndexMap m_node_index_map;
 
   protected:
     size_t get_edge_count(int from_id, int to_id) const;
     const std::unordered_set<int>& get_edgeids(int from_id, int to_id) const;
+    // ids of the edges returned by get_edges_of_node
+    virtual const std::unordered_set<int>& get_adjacent_edgeids(int node_id) const;
+    // add_edge of Graph without any check, the caller made sure both nodes exist; derived classes
+    // keeping their own edge maps do not see the edge
+    int add_edge_unchecked(int from_id, int to_id);
 
   public:
     virtual ~Graph() = default;
+    // lazy view over the neighbors of a node, same order as get_edges_of_node, no allocations
+    auto get_neighbors(const int node_id) const {
+        return get_adjacent_edgeids(node_id) |
+               std::views::transform([this, node_id](const int edge_id) -> GraphNeighbor {
+                   const GraphEdge& edge = *m_edgeid_to_edge_map.at(edge_id);
+                   const int from_id = edge.get_from_id();
+                   return {from_id == node_id ? edge.get_to_id() : from_id, edge_id};
+               });
+    }
     bool has_node(int node_id) const;
     const GraphNode& get_node_by_id(int id) const;
     std::vector<const GraphNode*> get_nodes() const;
     std::vector<int> get_nodes_ids() const;
+    // dense indices of the current nodes, invalidated by node removals
+    const NodeIndexMap& get_node_index_map() const { return m_node_index_map; }
     virtual std::vector<GraphEdge> get_edges_of_node(int node_id) const;
     virtual const GraphNode& add_node(int id);
     const GraphNode& add_node();
+    // makes room for that many nodes and edges in total in the lookup maps, so that adding them
+    // does not rehash them (the order of the nodes and of the edges stays the one of no reserve)
+    virtual void reserve(size_t number_of_nodes, size_t number_of_edges);
     virtual size_t get_degree_of_node(int node_id) const = 0;
     virtual int add_edge(int from_id, int to_id);
     virtual bool has_edge(int from_id, int to_id) const = 0;
@@ -73,9 +101,13 @@ class DirectedMultiGraph : public Graph {
     std::unordered_map<int, std::unordered_set<int>> m_nodeid_to_incoming_edgeids;
     std::unordered_map<int, std::unordered_set<int>> m_nodeid_to_outgoing_edgeids;
 
+  protected:
+    const std::unordered_set<int>& get_adjacent_edgeids(int node_id) const override;
+
   public:
     DirectedMultiGraph() = default;
     const GraphNode& add_node(int node_id) override;
+    void reserve(size_t number_of_nodes, size_t number_of_edges) override;
     int add_edge(int from_id, int to_id) override;
     std::vector<GraphEdge> get_edges_of_node(int node_id) const override;
     std::vector<GraphEdge> get_in_edges_of_node(int node_id) const;
@@ -123,6 +155,8 @@ class UndirectedMultiGraph : public Graph {
 };
 
 class UndirectedSimpleGraph final : public UndirectedMultiGraph {
+    friend class GraphBuilder;
+
   public:
     UndirectedSimpleGraph() = default;
     int add_edge(int from_id, int to_id) override;
@@ -147,6 +181,7 @@ class GraphNode {
     [[nodiscard]] std::vector<GraphEdge> get_edges() const {
         return m_graph_owner.get_edges_of_node(m_id);
     }
+    [[nodiscard]] auto get_neighbors() const { return m_graph_owner.get_neighbors(m_id); }
     [[nodiscard]] std::string to_string() const;
     [[nodiscard]] size_t get_degree() const;
     void print() const;
@@ -0,0 +1,40 @@
+#ifndef MY_GRAPH_BUILDER_H
+#define MY_GRAPH_BUILDER_H
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+
+// nodes and edges of an undirected simple graph collected in plain vectors and turned into the
+// graph all at once by finish: the graph is reserved for the edges, the edges are checked in a
+// single pass (with the same errors as UndirectedSimpleGraph::add_edge) and then inserted without
+// the lookups add_edge does for every edge; only the validation is deferred, each node and edge is
+// still inserted on its own into the hash maps of Graph, whose storage stays the same (CsrGraph is
+// the contiguous snapshot); nodes and edges keep the order they were added in, so the graph (ids,
+// and order of get_nodes_ids and get_edges) is the one consecutive add_node and add_edge calls
+// would build
+class GraphBuilder {
+    std::vector<int> m_nodes_ids;
+    std::vector<std::pair<int, int>> m_edges;
+
+  public:
+    GraphBuilder() = default;
+    GraphBuilder(size_t number_of_nodes, size_t number_of_edges);
+    void reserve(size_t number_of_nodes, size_t number_of_edges);
+    void add_node(int node_id);
+    void add_nodes(std::span<const int> nodes_ids);
+    void add_edge(int from_id, int to_id);
+    void add_edges(std::span<const std::pair<int, int>> edges);
+    [[nodiscard]] size_t get_number_of_nodes() const;
+    [[nodiscard]] size_t get_number_of_edges() const;
+    // the builder is left empty
+    std::unique_ptr<UndirectedSimpleGraph> finish();
+    // the nodes and edges are added to the ones already in the graph
+    void finish(UndirectedSimpleGraph& graph);
+};
+
+#endif
@@ -1,14 +1,18 @@
 #ifndef MY_GRAPHS_ALGORITHMS_H
 #define MY_GRAPHS_ALGORITHMS_H
 
+#include <limits>
 #include <optional>
 #include <vector>
 
+#include "core/graph/csr_graph.hpp"
 #include "core/graph/cycle.hpp"
 #include "core/graph/graph.hpp"
 
 bool is_graph_connected(const UndirectedSimpleGraph& graph);
 
+bool is_graph_connected(const CsrGraph& graph);
+
 std::vector<Cycle>
 compute_all_cycles_with_node_in_graph(const UndirectedSimpleGraph& graph,
                                       const GraphNode& node,
@@ -20,8 +24,20 @@ std::optional<Cycle> find_a_cycle_in_graph(const UndirectedSimpleGraph& graph);
 
 std::optional<Cycle> find_a_cycle_in_graph(const DirectedSimpleGraph& graph);
 
+// node-disjoint cycles found by a single depth first search (at most max_number_of_cycles), the
+// first one is the cycle returned by find_a_cycle_in_graph
+std::vector<Cycle> find_disjoint_cycles_in_graph(
+    const DirectedSimpleGraph& graph,
+    size_t max_number_of_cycles = std::numeric_limits<size_t>::max());
+
+std::vector<Cycle> find_disjoint_cycles_in_graph(
+    const CsrGraph& graph,
+    size_t max_number_of_cycles = std::numeric_limits<size_t>::max());
+
 std::vector<Cycle> compute_cycle_basis(const UndirectedSimpleGraph& graph);
 
+std::vector<Cycle> compute_cycle_basis(const CsrGraph& graph);
+
 std::vector<int> make_topological_ordering(const DirectedSimpleGraph& graph);
 
 bool are_cycles_equivalent(const Cycle& cycle1, const Cycle& cycle2);
@@ -47,6 +63,8 @@ class BiconnectedComponents {
 
 BiconnectedComponents compute_biconnected_components(const UndirectedSimpleGraph& graph);
 
+BiconnectedComponents compute_biconnected_components(const CsrGraph& graph);
+
 std::pair<std::unique_ptr<UndirectedSimpleGraph>, GraphEdgeHashSet>
 compute_maximal_degree_4_subgraph(const UndirectedSimpleGraph& graph);
 
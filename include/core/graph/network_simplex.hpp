@@ -0,0 +1,26 @@
+#ifndef MY_NETWORK_SIMPLEX_H
+#define MY_NETWORK_SIMPLEX_H
+
+#include <cstddef>
+#include <vector>
+
+// rank[to] - rank[from] must be at least min_length, and costs weight for each unit it takes
+struct RankConstraint {
+    size_t from;
+    size_t to;
+    int min_length;
+    int weight;
+};
+
+// integer ranks of the nodes [0, number_of_nodes) satisfying every constraint with the smallest
+// total cost, the smallest rank is 0; the network simplex of Gansner et al. ("A technique for
+// drawing directed graphs"): a feasible tree of tight constraints is improved by exchanging a tree
+// constraint with a negative cut value for the non tree one with the least slack; the constraints
+// must be acyclic, connect all nodes and have non negative min lengths and weights; there is no
+// anti-cycling rule, exchanges that move nothing (entering slack 0) could repeat forever, so the
+// exchanges stop after 64 per node, and then the ranks are still feasible but their total cost may
+// not be the smallest
+std::vector<int> compute_optimal_ranks(size_t number_of_nodes,
+                                       const std::vector<RankConstraint>& constraints);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MY_NODE_INDEX_MAP_H
+#define MY_NODE_INDEX_MAP_H
+
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// bijection between the current node ids of a graph and the dense range [0, size()),
+// removing a node moves the last node into the freed index, so indices are only stable
+// until the next removal
+class NodeIndexMap {
+    std::vector<int> m_index_to_node_id;
+    // ids small enough are addressed directly, the others (rare) go in the hash map
+    std::vector<size_t> m_dense_node_id_to_index;
+    std::unordered_map<int, size_t> m_sparse_node_id_to_index;
+    void set_index(int node_id, size_t index);
+
+  public:
+    static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+    void add_node(int node_id);
+    void remove_node(int node_id);
+    void reserve(size_t number_of_nodes);
+    [[nodiscard]] size_t size() const { return m_index_to_node_id.size(); }
+    [[nodiscard]] bool has_node(int node_id) const;
+    [[nodiscard]] size_t get_index(int node_id) const;
+    // NO_INDEX when the node is not there
+    [[nodiscard]] size_t find_index(int node_id) const;
+    [[nodiscard]] int get_node_id(const size_t index) const { return m_index_to_node_id[index]; }
+    [[nodiscard]] const std::vector<int>& get_nodes_ids() const { return m_index_to_node_id; }
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MY_MAPPED_FILE_H
+#define MY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// the whole content of a file, mapped read only in memory for as long as the object lives
+class MappedFile {
+    void* m_data = nullptr;
+    size_t m_size = 0;
+
+  public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    [[nodiscard]] std::span<const char> get_bytes() const {
+        return {static_cast<const char*>(m_data), m_size};
+    }
+};
+
+#endif
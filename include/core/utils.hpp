@@ -80,6 +80,7 @@ template <typename T> class CircularSequence {
         recompute_positions();
     }
     [[nodiscard]] size_t next_index(const size_t index) const { return (index + 1) % size(); }
+    void insert_before(T existing, T element) { insert(element_position(existing), element); }
     void remove_if_exists(T element) {
         if (!has_element(element))
             return;
@@ -115,4 +116,155 @@ template <typename T> class CircularSequence {
     [[nodiscard]] typename std::vector<T>::const_iterator end() const { return m_elements.end(); }
 };
 
+// same interface as CircularSequence, but the elements are kept in a doubly linked ring, so
+// insertions, removals, reversal and prev/next are O(1); positions and iteration go through an
+// order cache that is rebuilt lazily, once after a batch of changes (hence not thread-safe,
+// even for const access)
+template <typename T> class LinkedCircularSequence {
+    struct Links {
+        T prev;
+        T next;
+    };
+    std::unordered_map<T, Links> m_links;
+    T m_head{};
+    bool m_is_reversed = false;
+    mutable std::vector<T> m_order;
+    mutable std::unordered_map<T, size_t> m_order_position;
+    mutable bool m_is_order_valid = true;
+    T& next_link(T element) {
+        Links& links = m_links.at(element);
+        return m_is_reversed ? links.prev : links.next;
+    }
+    T& prev_link(T element) {
+        Links& links = m_links.at(element);
+        return m_is_reversed ? links.next : links.prev;
+    }
+    void refresh_order() const {
+        if (m_is_order_valid)
+            return;
+        m_order.clear();
+        m_order_position.clear();
+        T current = m_head;
+        for (size_t i = 0; i < size(); i++) {
+            m_order.push_back(current);
+            m_order_position[current] = i;
+            current = next_element(current);
+        }
+        m_is_order_valid = true;
+    }
+    // links element right before existing, the head is left unchanged
+    void link_before(T existing, T element) {
+        m_is_order_valid = false;
+        if (m_links.empty()) {
+            m_links[element] = {element, element};
+            m_head = element;
+            return;
+        }
+        const T prev = prev_link(existing);
+        m_links[element] = {};
+        prev_link(element) = prev;
+        next_link(element) = existing;
+        next_link(prev) = element;
+        prev_link(existing) = element;
+    }
+
+  public:
+    LinkedCircularSequence() = default;
+    explicit LinkedCircularSequence(const std::vector<T>& elements) {
+        for (const T& element : elements)
+            append(element);
+    }
+    void reverse() {
+        if (empty())
+            return;
+        m_head = prev_element(m_head);
+        m_is_reversed = !m_is_reversed;
+        m_is_order_valid = false;
+    }
+    void clear() {
+        m_links.clear();
+        m_is_reversed = false;
+        m_order.clear();
+        m_order_position.clear();
+        m_is_order_valid = true;
+    }
+    [[nodiscard]] bool empty() const { return m_links.empty(); }
+    [[nodiscard]] size_t size() const { return m_links.size(); }
+    void append(T element) {
+        if (has_element(element))
+            throw std::runtime_error("Element already exists");
+        link_before(m_head, element);
+    }
+    void insert(size_t index, T element) {
+        if (has_element(element))
+            throw std::runtime_error("Element already exists");
+        if (index == size()) {
+            link_before(m_head, element);
+            return;
+        }
+        insert_before(at(index), element);
+    }
+    void insert_before(T existing, T element) {
+        if (!has_element(existing))
+            throw std::runtime_error("Element not found");
+        if (has_element(element))
+            throw std::runtime_error("Element already exists");
+        link_before(existing, element);
+        if (existing == m_head)
+            m_head = element;
+    }
+    [[nodiscard]] size_t next_index(const size_t index) const { return (index + 1) % size(); }
+    void remove_if_exists(T element) {
+        if (!has_element(element))
+            return;
+        if (size() == 1) {
+            clear();
+            return;
+        }
+        const T prev = prev_link(element);
+        const T next = next_link(element);
+        next_link(prev) = next;
+        prev_link(next) = prev;
+        if (element == m_head)
+            m_head = next;
+        m_links.erase(element);
+        m_is_order_valid = false;
+    }
+    [[nodiscard]] T prev_element(T element) const {
+        if (!has_element(element))
+            throw std::runtime_error("Element not found");
+        const Links& links = m_links.at(element);
+        return m_is_reversed ? links.next : links.prev;
+    }
+    [[nodiscard]] T next_element(T element) const {
+        if (!has_element(element))
+            throw std::runtime_error("Element not found");
+        const Links& links = m_links.at(element);
+        return m_is_reversed ? links.prev : links.next;
+    }
+    [[nodiscard]] bool has_element(T element) const { return m_links.contains(element); }
+    [[nodiscard]] size_t element_position(T element) const {
+        if (!has_element(element))
+            throw std::runtime_error("Element not found");
+        refresh_order();
+        return m_order_position.at(element);
+    }
+    T operator[](const size_t index) const {
+        refresh_order();
+        return m_order[index];
+    }
+    [[nodiscard]] T at(const size_t index) const {
+        refresh_order();
+        return m_order.at(index);
+    }
+    [[nodiscard]] typename std::vector<T>::const_iterator begin() const {
+        refresh_order();
+        return m_order.begin();
+    }
+    [[nodiscard]] typename std::vector<T>::const_iterator end() const {
+        refresh_order();
+        return m_order.end();
+    }
+};
+
 #endif
\ No newline at end of file
@@ -4,6 +4,21 @@
 #include "core/graph/attributes.hpp"
 #include "core/graph/graph.hpp"
 
-void compact_area(const UndirectedSimpleGraph& graph, GraphAttributes& attributes);
+enum class AreaCompaction {
+    // every column (then row) of the drawing moves as a whole next to the closest previous one it
+    // overlaps
+    SHIFT_INDICES,
+    // each axis gets the longest paths of its constraint graph: the nodes joined by vertical
+    // (horizontal) edges move together and only stay after the ones they overlap, drawings not on
+    // the grid (nodes of degree more than 4) fall back to SHIFT_INDICES
+    CONSTRAINT_DAG,
+    // the classes of CONSTRAINT_DAG get the positions with the smallest total edge length plus
+    // width (height) from a network simplex, with the same fall back
+    NETWORK_SIMPLEX,
+};
 
-#endif
\ No newline at end of file
+void compact_area(const UndirectedSimpleGraph& graph,
+                  GraphAttributes& attributes,
+                  AreaCompaction compaction = AreaCompaction::SHIFT_INDICES);
+
+#endif
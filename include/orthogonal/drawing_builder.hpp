@@ -2,13 +2,20 @@
 #define MY_DRAWING_BUILDER_H
 
 #include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "core/graph/attributes.hpp"
+#include "core/graph/csr_graph.hpp"
 #include "core/graph/graph.hpp"
+#include "orthogonal/area_compacter.hpp"
 #include "orthogonal/shape/shape.hpp"
+#include "orthogonal/shape/shape_builder.hpp"
+#include "sat/kissat.hpp"
 
 class DisconnectedGraphError : public std::runtime_error {
   public:
@@ -19,6 +26,18 @@ void make_svg(const UndirectedSimpleGraph& graph,
               const GraphAttributes& attributes,
               const std::string& filename);
 
+// index of the coordinates of every node among the coordinates of a drawing, starting from 0 and
+// growing by one only between consecutive coordinates 100 apart; index_x[i] and index_y[i] are the
+// ones of the node at index i of node_index (the order of the given nodes ids)
+struct IndexPositions {
+    NodeIndexMap node_index;
+    std::vector<int> index_x;
+    std::vector<int> index_y;
+};
+
+IndexPositions compute_index_positions(std::span<const int> nodes_ids,
+                                       const GraphAttributes& attributes);
+
 struct DrawingResult {
     std::unique_ptr<UndirectedSimpleGraph> augmented_graph;
     GraphAttributes attributes;
@@ -26,12 +45,44 @@ struct DrawingResult {
     size_t initial_number_of_cycles;
     size_t number_of_added_cycles;
     size_t number_of_useless_bends;
+    // filled by the first get_index_positions, the drawing must not change afterwards
+    mutable std::optional<IndexPositions> index_positions = std::nullopt;
+};
+
+// index positions of the augmented graph of the result, computed once and then shared
+const IndexPositions& get_index_positions(const DrawingResult& result);
+
+// a drawing kept for later (by DrawingStore or ShapeCache)
+struct StoredDrawing {
+    DrawingResult result;
+    // seconds taken by the original computation
+    double time;
 };
 
-DrawingResult make_orthogonal_drawing(const UndirectedSimpleGraph& graph);
+// compacts the drawing of a result again, e.g. with AreaCompaction::NETWORK_SIMPLEX after it was
+// made with the default compaction
+void compact_drawing(DrawingResult& result, AreaCompaction compaction);
+
+struct DrawingOptions {
+    SatSolverOptions sat_options;
+    EdgeSplitOptions split_options;
+    // the shape of each biconnected component is solved on its own, in parallel (falls back to
+    // the whole graph when the problem cannot be split)
+    bool split_biconnected_components = false;
+    // violated cycles added to the shape problem after each solve, the disjoint cycles of both
+    // orderings are collected in one pass (0 means all of them)
+    size_t max_cycles_per_round = 1;
+    AreaCompaction area_compaction = AreaCompaction::SHIFT_INDICES;
+};
+
+DrawingResult make_orthogonal_drawing(const UndirectedSimpleGraph& graph,
+                                      const DrawingOptions& options = {});
 
 std::pair<std::unordered_map<int, int>, std::unordered_map<int, int>>
 compute_node_to_index_position(const UndirectedSimpleGraph& graph,
                                const GraphAttributes& attributes);
 
+std::pair<std::unordered_map<int, int>, std::unordered_map<int, int>>
+compute_node_to_index_position(const CsrGraph& graph, const GraphAttributes& attributes);
+
 #endif
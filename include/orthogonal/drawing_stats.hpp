@@ -1,6 +1,9 @@
 #ifndef MY_DRAWING_STATS_H
 #define MY_DRAWING_STATS_H
 
+#include <utility>
+#include <vector>
+
 #include "orthogonal/drawing_builder.hpp"
 
 int compute_total_edge_length(const DrawingResult& result);
@@ -30,6 +33,36 @@ struct OrthogonalStats {
     double bends_stddev;
 };
 
+// all the metrics of a drawing from a single computation of the index positions and a single walk
+// over the chains of corners drawing the edges, whose lengths and bends are kept, one per edge
+class OrthogonalStatsEngine {
+    const CsrGraph& m_graph;
+    const GraphAttributes& m_attributes;
+    std::vector<int> m_index_x;
+    std::vector<int> m_index_y;
+    // ids of the black nodes at the ends of every edge, smaller first
+    std::vector<std::pair<int, int>> m_edges;
+    std::vector<int> m_edge_lengths;
+    std::vector<int> m_bends_counts;
+
+  public:
+    // graph must be the csr snapshot of the augmented graph the attributes belong to
+    OrthogonalStatsEngine(const CsrGraph& graph, const GraphAttributes& attributes);
+    // with the index positions already computed (see get_index_positions)
+    OrthogonalStatsEngine(const CsrGraph& graph,
+                          const GraphAttributes& attributes,
+                          const IndexPositions& index_positions);
+    [[nodiscard]] const std::vector<std::pair<int, int>>& get_edges() const;
+    [[nodiscard]] const std::vector<int>& get_edge_lengths() const;
+    [[nodiscard]] const std::vector<int>& get_bends_counts() const;
+    [[nodiscard]] int compute_total_area() const;
+    [[nodiscard]] int compute_total_crossings() const;
+    [[nodiscard]] OrthogonalStats compute_stats() const;
+};
+
 OrthogonalStats compute_all_orthogonal_stats(const DrawingResult& result);
 
+// graph must be the csr snapshot of result.augmented_graph
+OrthogonalStats compute_all_orthogonal_stats(const DrawingResult& result, const CsrGraph& graph);
+
 #endif
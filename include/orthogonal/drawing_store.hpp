@@ -0,0 +1,54 @@
+#ifndef MY_DRAWING_STORE_H
+#define MY_DRAWING_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "orthogonal/drawing_builder.hpp"
+
+// 64-bit FNV-1a, stable across runs and platforms
+uint64_t fnv1a_hash(std::string_view bytes);
+
+// drawings on disk, addressed by the hash of the content of their graph file: data.bin holds the
+// drawings (in the binary format of orthogonal/file_loader) one after the other and is only
+// appended to, index.bin is a memory mapped open addressing table from hashes to drawings,
+// doubled (and rewritten) when half full
+class DrawingStore {
+    std::string m_folder;
+    int m_index_fd = -1;
+    int m_data_fd = -1;
+    char* m_index = nullptr;
+    size_t m_index_size = 0;
+    const char* m_data = nullptr;
+    size_t m_data_mapped_size = 0;
+    size_t m_data_size = 0;
+    mutable std::mutex m_mutex;
+    void map_index(size_t size);
+    void unmap_index();
+    void create_index(const std::string& path, uint64_t capacity);
+    void grow_index();
+    void map_data();
+    [[nodiscard]] uint64_t get_capacity() const;
+    [[nodiscard]] uint64_t get_number_of_entries() const;
+    // slot of the key, or the empty slot where it would go
+    [[nodiscard]] size_t find_slot(uint64_t key) const;
+    // the slot at the position holds the key and its drawing is entirely in the data
+    [[nodiscard]] bool has_entry(size_t position, uint64_t key) const;
+
+  public:
+    explicit DrawingStore(std::string folder);
+    ~DrawingStore();
+    DrawingStore(const DrawingStore&) = delete;
+    DrawingStore& operator=(const DrawingStore&) = delete;
+    [[nodiscard]] bool contains(uint64_t key) const;
+    std::optional<StoredDrawing> find(uint64_t key);
+    // a key already in the store keeps its drawing, unless its drawing was never fully written
+    void insert(uint64_t key, const DrawingResult& result, double time);
+    [[nodiscard]] size_t size() const;
+};
+
+#endif
@@ -1,43 +1,96 @@
 #ifndef MY_EUIVALENCE_CLASSES_H
 #define MY_EUIVALENCE_CLASSES_H
 
-#include <ranges>
+#include <optional>
+#include <span>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
-#include "core/graph/attributes.hpp"
 #include "core/graph/graph.hpp"
+#include "core/graph/node_index_map.hpp"
 #include "orthogonal/shape/shape.hpp"
 
+// flat union-find: every element stores its class directly and every class the list of its
+// elements, so that a class can be merged into another one or split in two
 class EquivalenceClasses {
-    std::unordered_map<int, int> m_elem_to_class;
-    std::unordered_map<int, std::unordered_set<int>> m_class_to_elems;
-    bool has_class(int class_id) const;
+    NodeIndexMap m_elem_index;
+    std::vector<int> m_elem_to_class;
+    // position of each element inside the elements of its class
+    std::vector<size_t> m_elem_position;
+    std::vector<std::vector<int>> m_class_to_elems;
+    std::vector<int> m_free_classes;
+    int make_class();
+    void detach_elem(size_t elem_index);
 
   public:
-    void set_class(int elem, int class_id);
+    // the elements (not yet in any class) form a new class, whose id is returned
+    int add_elems(std::span<const int> elems);
     bool has_elem_a_class(int elem) const;
     int get_class_of_elem(int elem) const;
-    const std::unordered_set<int>& get_elems_of_class(int class_id) const;
+    bool has_class(int class_id) const;
+    const std::vector<int>& get_elems_of_class(int class_id) const;
+    // classes left empty are deleted and their ids are reused
+    void move_elems(std::span<const int> elems, int class_id);
+    int move_elems_to_new_class(std::span<const int> elems);
+    std::vector<int> get_all_classes() const;
     std::string to_string() const;
     void print() const;
-    auto get_all_classes() const {
-        return m_class_to_elems |
-               std::views::transform([](const auto& pair) -> int { return pair.first; });
-    }
 };
 
-std::pair<const EquivalenceClasses, const EquivalenceClasses>
-build_equivalence_classes(const Shape& shape, const UndirectedSimpleGraph& graph);
+enum class Axis { X, Y };
+
+// nodes joined by vertical edges share the x coordinate, nodes joined by horizontal edges the y
+// one: for each axis, the classes of nodes sharing the coordinate and the ordering between them
+// (an edge from class a to class b if some edge goes right, or up, from a node of a to a node of
+// b), both patched in place when an edge changes direction or a node is added
+class ShapeOrderings {
+    struct AxisOrdering {
+        EquivalenceClasses classes;
+        DirectedSimpleGraph ordering;
+        // number of edges of the graph behind each edge of the ordering
+        GraphEdgeHashMap<size_t> multiplicity;
+        // spanning tree of every class (by node index), rebuilt lazily after any change
+        mutable std::vector<size_t> forest_parent;
+        mutable std::vector<size_t> forest_depth;
+        mutable bool is_forest_valid = false;
+    };
+    NodeIndexMap m_nodes_index;
+    std::vector<std::vector<std::pair<int, Direction>>> m_neighbors;
+    std::vector<bool> m_is_moving;
+    AxisOrdering m_x;
+    AxisOrdering m_y;
+    AxisOrdering& get_axis(Axis axis) { return axis == Axis::X ? m_x : m_y; }
+    const AxisOrdering& get_axis(Axis axis) const { return axis == Axis::X ? m_x : m_y; }
+    std::vector<std::pair<int, Direction>>& get_neighbors(int node_id);
+    const std::vector<std::pair<int, Direction>>& get_neighbors(int node_id) const;
+    std::vector<int> collect_class_component(Axis axis, int node_id);
+    void build_classes_forest(Axis axis) const;
+    void invalidate_classes_forests();
+    void build_axis(Axis axis);
+    void add_ordering_edge(Axis axis, int from_id, int to_id, Direction direction);
+    void remove_ordering_edge(Axis axis, int from_id, int to_id, Direction direction);
+    void change_ordering_edges(Axis axis, std::span<const int> nodes_ids, bool add);
+    void move_nodes(Axis axis, std::span<const int> nodes_ids, std::optional<int> class_id);
+    void join_classes(Axis axis, int node_id_1, int node_id_2);
+    void split_class(Axis axis, int node_id_1, int node_id_2);
 
-std::tuple<std::unique_ptr<DirectedSimpleGraph>,
-           std::unique_ptr<DirectedSimpleGraph>,
-           GraphAttributes,
-           GraphAttributes>
-equivalence_classes_to_ordering(const EquivalenceClasses& equivalence_classes_x,
-                                const EquivalenceClasses& equivalence_classes_y,
-                                const UndirectedSimpleGraph& graph,
-                                const Shape& shape);
+  public:
+    ShapeOrderings(const UndirectedSimpleGraph& graph, const Shape& shape);
+    void add_node(int node_id);
+    // direction goes from from_id to to_id
+    void add_edge(int from_id, int to_id, Direction direction);
+    void remove_edge(int from_id, int to_id);
+    void change_direction(int from_id, int to_id, Direction direction);
+    // brings the orderings in line with a graph that may have gained nodes and edges (or lost
+    // edges) and with a shape that may have changed the direction of some edges
+    void update(const UndirectedSimpleGraph& graph, const Shape& shape);
+    const EquivalenceClasses& get_classes(Axis axis) const { return get_axis(axis).classes; }
+    const DirectedSimpleGraph& get_ordering(Axis axis) const { return get_axis(axis).ordering; }
+    // an edge of the graph behind the edge (from_class, to_class) of the ordering
+    std::pair<int, int> get_ordering_edge_witness(Axis axis, int from_class, int to_class) const;
+    // simple path from from_id to to_id (both included) along the edges of their class
+    std::vector<int> get_path_in_class(Axis axis, int from_id, int to_id) const;
+};
 
-#endif
\ No newline at end of file
+#endif
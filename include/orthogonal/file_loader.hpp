@@ -1,9 +1,14 @@
 #ifndef MY_SHAPE_FILE_LOADER_H
 #define MY_SHAPE_FILE_LOADER_H
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <utility>
 
 #include "core/graph/graph.hpp"
+#include "orthogonal/drawing_builder.hpp"
 #include "orthogonal/shape/shape.hpp"
 
 Shape load_shape_from_file(const std::string& filename);
@@ -12,4 +17,45 @@ void save_shape_to_file(const DirectedSimpleGraph& graph,
                         const Shape& shape,
                         const std::string& filename);
 
+// versioned binary drawing, in host byte order (little endian on every supported target): a
+// header (magic, version, number of nodes and edges, counters of the drawing), then the ids, x
+// and y positions and colors of the nodes, the edges as pairs of ids, and the direction of every
+// edge (going from its first node to its second, the other way being the opposite direction)
+// packed in 2 bits
+std::string drawing_result_to_binary(const DrawingResult& result);
+
+void save_drawing_result_to_binary_file(const DrawingResult& result, const std::string& filename);
+
+// reads a binary drawing in place, the bytes must outlive the view
+class DrawingResultView {
+    std::span<const char> m_bytes;
+    size_t m_number_of_nodes;
+    size_t m_number_of_edges;
+    size_t m_positions_x_offset;
+    size_t m_positions_y_offset;
+    size_t m_colors_offset;
+    size_t m_edges_offset;
+    size_t m_directions_offset;
+    [[nodiscard]] int read_int(size_t offset) const;
+    [[nodiscard]] uint64_t read_counter(size_t index) const;
+
+  public:
+    explicit DrawingResultView(std::span<const char> bytes);
+    [[nodiscard]] size_t get_number_of_nodes() const { return m_number_of_nodes; }
+    [[nodiscard]] int get_node_id(size_t index) const;
+    [[nodiscard]] Color get_node_color(size_t index) const;
+    [[nodiscard]] int get_position_x(size_t index) const;
+    [[nodiscard]] int get_position_y(size_t index) const;
+    [[nodiscard]] size_t get_number_of_edges() const { return m_number_of_edges; }
+    [[nodiscard]] std::pair<int, int> get_edge(size_t index) const;
+    [[nodiscard]] Direction get_direction(size_t index) const;
+    [[nodiscard]] size_t get_initial_number_of_cycles() const;
+    [[nodiscard]] size_t get_number_of_added_cycles() const;
+    [[nodiscard]] size_t get_number_of_useless_bends() const;
+    [[nodiscard]] DrawingResult to_drawing_result() const;
+};
+
+// the file is mapped in memory, not read
+DrawingResult load_drawing_result_from_binary_file(const std::string& filename);
+
 #endif
\ No newline at end of file
@@ -6,6 +6,12 @@
 #include "orthogonal/shape/variables_handler.hpp"
 #include "sat/cnf.hpp"
 
+// the edge (from_id, to_id) has exactly one direction
+void add_edge_constraints(Cnf& cnf_builder,
+                          const VariablesHandler& handler,
+                          int from_id,
+                          int to_id);
+
 // each edge can only be in one direction
 void add_constraints_one_direction_per_edge(const UndirectedSimpleGraph& graph,
                                             Cnf& cnf_builder,
@@ -23,10 +29,16 @@ void add_one_edge_per_direction_clauses(Cnf& cnf_builder,
                                         Direction direction,
                                         const GraphNode& node);
 
+// constraints on the directions of the edges around the node
+void add_node_constraints(Cnf& cnf_builder, const VariablesHandler& handler, const GraphNode& node);
+
 void add_nodes_constraints(const UndirectedSimpleGraph& graph,
                            Cnf& cnf_builder,
                            const VariablesHandler& handler);
 
+// the cycle goes at least once in every direction
+void add_cycle_constraints(Cnf& cnf_builder, const Cycle& cycle, const VariablesHandler& handler);
+
 void add_cycles_constraints(Cnf& cnf_builder,
                             const std::vector<Cycle>& cycles,
                             const VariablesHandler& handler);
@@ -1,16 +1,51 @@
 #ifndef MY_SHAPE_BUILDER_H
 #define MY_SHAPE_BUILDER_H
 
+#include <optional>
 #include <vector>
 
 #include "core/graph/attributes.hpp"
 #include "core/graph/cycle.hpp"
 #include "core/graph/graph.hpp"
 #include "orthogonal/shape/shape.hpp"
+#include "orthogonal/shape/shape_encoder.hpp"
+#include "sat/kissat.hpp"
 
+enum class EdgeSplitSelection {
+    // edges of the last unit clauses of the DRAT proof
+    PROOF_UNIT_CLAUSES,
+    // edges of a minimized unsatisfiable core, found without any proof: the clauses of each edge
+    // are guarded by a selector, and groups of selectors are dropped as long as the problem
+    // stays UNSAT
+    MINIMIZED_CORE
+};
+
+// how the edges that get a corner are chosen after an UNSAT answer
+struct EdgeSplitOptions {
+    EdgeSplitSelection selection = EdgeSplitSelection::PROOF_UNIT_CLAUSES;
+    // 1 picks one of the last two unit clauses of the proof (or one edge of the core), more
+    // splits at once the distinct edges of the last unit clauses (or of the core), 0 means all
+    size_t max_edges_per_round = 1;
+};
+
+// when a solve runs out of budget (see sat_options), a corner is added on the longest cycle
 Shape build_shape(UndirectedSimpleGraph& graph,
                   GraphAttributes& attributes,
                   std::vector<Cycle>& cycles,
-                  bool randomize = false);
+                  bool randomize = false,
+                  const SatSolverOptions& sat_options = {},
+                  const EdgeSplitOptions& split_options = {},
+                  ForbiddenDirections forbidden_directions = {});
+
+// solves the shape of every biconnected component on its own (in parallel), the ports of each
+// cut vertex are split among its components, nullopt if the problem cannot be split (a cut
+// vertex with more than four edges, or a cycle going through more components)
+std::optional<Shape>
+build_shape_by_biconnected_components(UndirectedSimpleGraph& graph,
+                                      GraphAttributes& attributes,
+                                      std::vector<Cycle>& cycles,
+                                      bool randomize = false,
+                                      const SatSolverOptions& sat_options = {},
+                                      const EdgeSplitOptions& split_options = {});
 
 #endif
\ No newline at end of file
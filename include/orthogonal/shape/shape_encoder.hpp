@@ -0,0 +1,58 @@
+#ifndef MY_SHAPE_ENCODER_H
+#define MY_SHAPE_ENCODER_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/graph/cycle.hpp"
+#include "core/graph/graph.hpp"
+#include "orthogonal/shape/variables_handler.hpp"
+#include "sat/cnf.hpp"
+
+// the clauses of every edge, each guarded by a selector variable (numbered after the variables of
+// the handler) so that they only hold when their selector is true
+struct GuardedEdgesClauses {
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> selectors;
+    Cnf clauses;
+};
+
+// for some nodes, directions that none of their edges can take
+using ForbiddenDirections = std::unordered_map<int, std::vector<Direction>>;
+
+// keeps the variables and the clauses of the shape problem across the rounds of build_shape,
+// the clauses are grouped in blocks (one per edge, node and cycle) so that splitting an edge
+// only re-encodes the blocks touching it
+class ShapeEncoder {
+    const UndirectedSimpleGraph& m_graph;
+    const std::vector<Cycle>& m_cycles;
+    VariablesHandler m_handler;
+    std::vector<Cnf> m_edges_clauses;
+    GraphEdgeHashMap<size_t> m_edge_to_block;
+    std::vector<size_t> m_free_edge_blocks;
+    std::vector<Cnf> m_nodes_clauses;
+    std::unordered_map<int, size_t> m_node_to_block;
+    std::vector<Cnf> m_cycles_clauses;
+    ForbiddenDirections m_forbidden_directions;
+    void encode_edge(int from_id, int to_id);
+    void remove_edge(int from_id, int to_id);
+    void encode_node(int node_id);
+    void encode_cycle(size_t cycle_index);
+
+  public:
+    ShapeEncoder(const UndirectedSimpleGraph& graph,
+                 const std::vector<Cycle>& cycles,
+                 ForbiddenDirections forbidden_directions = {});
+    // to be called once the edge (from_id, to_id) has been replaced by the path through
+    // new_node_id, both in the graph and in the cycles
+    void update_after_split(int from_id, int to_id, int new_node_id);
+    [[nodiscard]] const VariablesHandler& get_handler() const { return m_handler; }
+    [[nodiscard]] VariablesHandler& get_handler() { return m_handler; }
+    // edges, nodes and cycles clauses, in this order
+    [[nodiscard]] std::vector<const Cnf*> get_cnf_blocks() const;
+    [[nodiscard]] std::vector<const Cnf*> get_nodes_and_cycles_cnf_blocks() const;
+    [[nodiscard]] GuardedEdgesClauses get_guarded_edges_clauses() const;
+};
+
+#endif
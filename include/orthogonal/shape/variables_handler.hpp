@@ -21,6 +21,11 @@ class VariablesHandler {
 
   public:
     explicit VariablesHandler(const UndirectedSimpleGraph& graph);
+    // the variables of removed edges are retired, numbers are never reused
+    void add_edge(int i, int j);
+    void remove_edge(int i, int j);
+    [[nodiscard]] bool has_variable(int variable) const;
+    [[nodiscard]] int get_number_of_variables() const { return m_next_var - 1; }
     int get_up_variable(int i, int j) const;
     int get_down_variable(int i, int j) const;
     int get_left_variable(int i, int j) const;
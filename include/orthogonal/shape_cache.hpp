@@ -0,0 +1,95 @@
+#ifndef MY_SHAPE_CACHE_H
+#define MY_SHAPE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+#include "orthogonal/drawing_builder.hpp"
+
+// nodes of the graph in an order that does not depend on their ids (as long as color refinement
+// tells all of them apart), together with the edges between positions in that order
+struct CanonicalGraph {
+    std::vector<int> nodes_ids;
+    std::vector<std::pair<size_t, size_t>> edges;
+    uint64_t hash;
+};
+
+CanonicalGraph make_canonical_graph(const UndirectedSimpleGraph& graph);
+
+// hash of every option that can change the drawing, stable across runs and platforms
+uint64_t hash_drawing_options(const DrawingOptions& options);
+
+// a drawing where the nodes of the input graph are named by their canonical position, and the
+// nodes added while drawing by the positions that follow
+struct CachedDrawing {
+    uint64_t graph_hash;
+    uint64_t options_hash;
+    size_t number_of_nodes;
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<Color> colors;
+    std::vector<int> positions_x;
+    std::vector<int> positions_y;
+    // direction of every edge of the augmented graph, going from the first node to the second
+    std::vector<std::pair<size_t, size_t>> augmented_edges;
+    std::vector<Direction> directions;
+    size_t initial_number_of_cycles;
+    size_t number_of_added_cycles;
+    size_t number_of_useless_bends;
+    // seconds taken by the original computation
+    double time;
+    [[nodiscard]] size_t get_size_in_bytes() const;
+};
+
+// drawings already computed, reused for the same graph, even with its nodes relabeled, and the
+// same options; the least recently used drawings are evicted once the cache exceeds max_bytes,
+// if a file is given the cache is loaded from it and save writes it back
+class ShapeCache {
+    using Entries = std::list<CachedDrawing>;
+    size_t m_max_bytes;
+    std::string m_file_path;
+    size_t m_size_in_bytes = 0;
+    size_t m_number_of_hits = 0;
+    size_t m_number_of_misses = 0;
+    // most recently used first
+    Entries m_entries;
+    std::unordered_map<uint64_t, std::vector<Entries::iterator>> m_key_to_entries;
+    mutable std::mutex m_mutex;
+    // the caller holds the mutex
+    Entries::iterator find_entry(const CanonicalGraph& canonical, uint64_t options_hash);
+    void add_entry(CachedDrawing drawing);
+    void evict();
+    void load();
+    std::optional<StoredDrawing> find_drawing(const CanonicalGraph& canonical,
+                                              uint64_t options_hash);
+    void insert_drawing(const CanonicalGraph& canonical,
+                        uint64_t options_hash,
+                        const DrawingResult& result,
+                        double time);
+
+  public:
+    explicit ShapeCache(size_t max_bytes, std::string file_path = "");
+    // the time is the one of the original computation, also when the drawing is cached
+    StoredDrawing make_orthogonal_drawing(const UndirectedSimpleGraph& graph,
+                                          const DrawingOptions& options = {});
+    std::optional<StoredDrawing> find(const UndirectedSimpleGraph& graph,
+                                      const DrawingOptions& options = {});
+    void insert(const UndirectedSimpleGraph& graph,
+                const DrawingOptions& options,
+                const DrawingResult& result,
+                double time);
+    void save() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t get_size_in_bytes() const;
+    [[nodiscard]] size_t get_number_of_hits() const;
+    [[nodiscard]] size_t get_number_of_misses() const;
+};
+
+#endif
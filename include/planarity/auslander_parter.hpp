@@ -3,9 +3,12 @@
 
 #include <optional>
 
+#include "core/graph/csr_graph.hpp"
 #include "core/graph/graph.hpp"
 #include "planarity/embedding.hpp"
 
 std::optional<Embedding> embed_graph(const UndirectedSimpleGraph& graph);
 
+std::optional<Embedding> embed_graph(const CsrGraph& graph);
+
 #endif
\ No newline at end of file
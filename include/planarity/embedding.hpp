@@ -4,6 +4,7 @@
 #include <ranges>
 #include <string>
 
+#include "core/graph/csr_graph.hpp"
 #include "core/graph/graph.hpp"
 #include "core/utils.hpp"
 
@@ -15,6 +16,7 @@ class Embedding {
 
   public:
     explicit Embedding(const UndirectedSimpleGraph& graph);
+    explicit Embedding(const CsrGraph& graph);
     void add_edge(int from_id, int to_id);
     const CircularSequence<int>& get_adjacency_list(int node_id) const;
     auto get_nodes_ids() const {
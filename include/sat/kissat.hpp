@@ -2,19 +2,47 @@
 #define MY_KISSAT_SOLVER_H
 
 #include "sat/cnf.hpp"
+#include <chrono>
+#include <cstddef>
 #include <string>
 #include <vector>
 
-enum class SatSolverResultType { SAT, UNSAT };
+// UNKNOWN when one of the limits of the solver has been reached
+enum class SatSolverResultType { SAT, UNSAT, UNKNOWN };
+
+struct SatSolverOptions {
+    // without a proof, UNSAT answers come without unit clauses (and the proof is never written)
+    bool produce_proof = true;
+    // binary DRAT proofs are parsed while being written, only their unit clauses are kept,
+    // text proofs are also returned line by line
+    bool binary_proof = true;
+    // how many of the last unit clauses of the proof are kept, 0 keeps all of them (only the last
+    // ones are used to choose the edges to split)
+    size_t max_unit_clauses = 64;
+    // budgets of a single solve, 0 means unlimited
+    unsigned conflict_limit = 0;
+    unsigned decision_limit = 0;
+    std::chrono::milliseconds time_limit{0};
+    // differently configured solvers racing on separate threads, the first answer wins
+    // (always 1 on emscripten)
+    size_t portfolio_size = 1;
+};
 
 struct SatSolverResult {
     SatSolverResultType result;
     std::vector<int> numbers;
     std::vector<std::string> proof_lines;
+    // unit clauses added in the proof, in order (only the last ones if bounded)
+    std::vector<int> unit_clauses;
+    size_t number_of_unit_clauses = 0;
     [[nodiscard]] std::string to_string() const;
     void print() const;
 };
 
-SatSolverResult launch_kissat(const Cnf& cnf);
+SatSolverResult launch_kissat(const Cnf& cnf, const SatSolverOptions& options = {});
+
+// solves the conjunction of all the cnfs
+SatSolverResult launch_kissat(const std::vector<const Cnf*>& cnfs,
+                              const SatSolverOptions& options = {});
 
 #endif
\ No newline at end of file
@@ -21,6 +21,7 @@ class ConfigImpl {
             }
         }
     }
+    bool has(const std::string& key) const { return m_config_map.contains(key); }
     const std::string& get(const std::string& key) const {
         if (!m_config_map.contains(key))
             throw std::runtime_error("Config: key not found " + key);
@@ -32,6 +33,8 @@ Config::Config(const std::string& filename) {
     m_config_impl = std::make_unique<ConfigImpl>(filename);
 }
 
+bool Config::has(const std::string& key) const { return m_config_impl->has(key); }
+
 const std::string& Config::get(const std::string& key) const { return m_config_impl->get(key); }
 
 Config::~Config() = default;
\ No newline at end of file
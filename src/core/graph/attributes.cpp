@@ -1,79 +1,144 @@
 #include "core/graph/attributes.hpp"
 
 #include <iostream>
-#include <ranges>
-
-struct NodePosition {
-    int x_m;
-    int y_m;
-    NodePosition(const int x, const int y) {
-        this->x_m = x;
-        this->y_m = y;
-    }
-    bool operator==(const NodePosition& other) const {
-        return x_m == other.x_m && y_m == other.y_m;
-    }
-};
+
+size_t attribute_slot(const Attribute attribute) { return static_cast<size_t>(attribute); }
+
+bool is_in_column(const NodeIndexMap& slots, const std::vector<bool>& presence, const int id) {
+    const size_t slot = slots.find_index(id);
+    return slot < presence.size() && presence[slot];
+}
+
+// slot of the id, a new one if it has none yet
+size_t get_or_add_slot(NodeIndexMap& slots, const int id) {
+    if (id < 0)
+        throw std::runtime_error("GraphAttributes: id must be non-negative");
+    const size_t slot = slots.find_index(id);
+    if (slot != NodeIndexMap::NO_INDEX)
+        return slot;
+    slots.add_node(id);
+    return slots.size() - 1;
+}
+
+template <typename T>
+void grow_column(std::vector<T>& column, std::vector<bool>& presence, const size_t slot) {
+    if (slot < presence.size())
+        return;
+    const size_t new_size = std::max(slot + 1, 2 * presence.size());
+    column.resize(new_size);
+    presence.resize(new_size, false);
+}
 
 bool GraphAttributes::has_attribute(const Attribute attribute) const {
-    return mattribute_to_node.contains(attribute);
+    return m_has_attribute[attribute_slot(attribute)];
 }
 
 void GraphAttributes::add_attribute(const Attribute attribute) {
     if (has_attribute(attribute))
         throw std::runtime_error("GraphAttributes::add_attribute: already has this attribute");
-    mattribute_to_node[attribute] = {};
+    m_has_attribute[attribute_slot(attribute)] = true;
 }
 
 void GraphAttributes::remove_attribute(const Attribute attribute) {
     if (!has_attribute(attribute))
         throw std::runtime_error("GraphAttributes::remove_attribute: does not have this attribute");
-    mattribute_to_node.erase(attribute);
+    m_has_attribute[attribute_slot(attribute)] = false;
+    switch (attribute) {
+    case Attribute::NODES_COLOR:
+        m_nodes_color.clear();
+        m_has_node_color.clear();
+        break;
+    case Attribute::NODES_POSITION:
+        m_positions_x.clear();
+        m_positions_y.clear();
+        m_has_node_position.clear();
+        break;
+    case Attribute::EDGES_ANY_LABEL:
+        m_edges_any_label.clear();
+        break;
+    case Attribute::EDGES_INT_PAIR_LABEL:
+        m_edges_int_pair_label.clear();
+        m_has_edge_int_pair_label.clear();
+        break;
+    }
 }
 
 void GraphAttributes::remove_nodes_attribute(const int node_id) {
-    for (auto nodes_attributes : mattribute_to_node | std::views::values) {
-        nodes_attributes.erase(node_id);
-    }
+    const size_t slot = m_nodes_slots.find_index(node_id);
+    if (slot < m_has_node_color.size())
+        m_has_node_color[slot] = false;
+    if (slot < m_has_node_position.size())
+        m_has_node_position[slot] = false;
 }
 
 bool GraphAttributes::has_attribute_by_id(const Attribute attribute, const int id) const {
     if (!has_attribute(attribute))
         throw std::runtime_error("GraphAttributes::has_attribute_by_id: does not have attribute");
-    return mattribute_to_node.at(attribute).contains(id);
+    switch (attribute) {
+    case Attribute::NODES_COLOR:
+        return is_in_column(m_nodes_slots, m_has_node_color, id);
+    case Attribute::NODES_POSITION:
+        return is_in_column(m_nodes_slots, m_has_node_position, id);
+    case Attribute::EDGES_ANY_LABEL:
+        return m_edges_any_label.contains(id);
+    case Attribute::EDGES_INT_PAIR_LABEL:
+        return is_in_column(m_edges_slots, m_has_edge_int_pair_label, id);
+    }
+    throw std::runtime_error("GraphAttributes::has_attribute_by_id: unknown attribute");
 }
 
 void GraphAttributes::set_node_color(const int node_id, const Color color) {
     if (has_attribute_by_id(Attribute::NODES_COLOR, node_id))
         throw std::runtime_error("GraphAttributes::set_node_color: the node already has color");
-    mattribute_to_node.at(Attribute::NODES_COLOR)[node_id] = color;
+    const size_t slot = get_or_add_slot(m_nodes_slots, node_id);
+    grow_column(m_nodes_color, m_has_node_color, slot);
+    m_nodes_color[slot] = color;
+    m_has_node_color[slot] = true;
 }
 
 Color GraphAttributes::get_node_color(const int node_id) const {
     if (!has_attribute_by_id(Attribute::NODES_COLOR, node_id))
         throw std::runtime_error("GraphAttributes::get_node_color: the node does not have a color");
-    return std::any_cast<Color>(mattribute_to_node.at(Attribute::NODES_COLOR).at(node_id));
+    return m_nodes_color[m_nodes_slots.get_index(node_id)];
 }
 
 void GraphAttributes::change_node_color(const int node_id, const Color color) {
     if (!has_attribute_by_id(Attribute::NODES_COLOR, node_id))
         throw std::runtime_error(
             "GraphAttributes::change_node_color: the node does not have a color");
-    mattribute_to_node.at(Attribute::NODES_COLOR)[node_id] = color;
+    m_nodes_color[m_nodes_slots.get_index(node_id)] = color;
 }
 
 void GraphAttributes::set_edge_any_label(const int edge_id, const std::any& label) {
     if (has_attribute_by_id(Attribute::EDGES_ANY_LABEL, edge_id))
         throw std::runtime_error(
             "GraphAttributes::set_edge_any_label: the edge already has a label");
-    mattribute_to_node.at(Attribute::EDGES_ANY_LABEL)[edge_id] = label;
+    m_edges_any_label[edge_id] = label;
 }
 
 const std::any& GraphAttributes::get_edge_any_label(const int edge_id) const {
     if (!has_attribute_by_id(Attribute::EDGES_ANY_LABEL, edge_id))
         throw std::runtime_error(
             "GraphAttributes::get_edge_any_label: the edge does not have a label");
-    return mattribute_to_node.at(Attribute::EDGES_ANY_LABEL).at(edge_id);
+    return m_edges_any_label.at(edge_id);
+}
+
+void GraphAttributes::set_edge_int_pair_label(const int edge_id,
+                                              const std::pair<int, int> label) {
+    if (has_attribute_by_id(Attribute::EDGES_INT_PAIR_LABEL, edge_id))
+        throw std::runtime_error(
+            "GraphAttributes::set_edge_int_pair_label: the edge already has a label");
+    const size_t slot = get_or_add_slot(m_edges_slots, edge_id);
+    grow_column(m_edges_int_pair_label, m_has_edge_int_pair_label, slot);
+    m_edges_int_pair_label[slot] = label;
+    m_has_edge_int_pair_label[slot] = true;
+}
+
+std::pair<int, int> GraphAttributes::get_edge_int_pair_label(const int edge_id) const {
+    if (!has_attribute_by_id(Attribute::EDGES_INT_PAIR_LABEL, edge_id))
+        throw std::runtime_error(
+            "GraphAttributes::get_edge_int_pair_label: the edge does not have a label");
+    return m_edges_int_pair_label[m_edges_slots.get_index(edge_id)];
 }
 
 void GraphAttributes::change_position(const int node_id, const int x, const int y) {
@@ -82,10 +147,9 @@ void GraphAttributes::change_position(const int node_id, const int x, const int
                                  "attribute");
     if (!has_position(node_id))
         throw std::runtime_error("GraphAttributes::change_position Node does not have a position");
-    auto& position =
-        std::any_cast<NodePosition&>(mattribute_to_node.at(Attribute::NODES_POSITION).at(node_id));
-    position.x_m = x;
-    position.y_m = y;
+    const size_t slot = m_nodes_slots.get_index(node_id);
+    m_positions_x[slot] = x;
+    m_positions_y[slot] = y;
 }
 
 void GraphAttributes::change_position_x(const int node_id, const int x) {
@@ -94,9 +158,7 @@ void GraphAttributes::change_position_x(const int node_id, const int x) {
                                  "attribute");
     if (!has_position(node_id))
         throw std::runtime_error("GraphAttributes::change_position Node does not have a position");
-    auto& position =
-        std::any_cast<NodePosition&>(mattribute_to_node.at(Attribute::NODES_POSITION).at(node_id));
-    position.x_m = x;
+    m_positions_x[m_nodes_slots.get_index(node_id)] = x;
 }
 
 void GraphAttributes::change_position_y(const int node_id, const int y) {
@@ -106,9 +168,7 @@ void GraphAttributes::change_position_y(const int node_id, const int y) {
     if (!has_position(node_id))
         throw std::runtime_error(
             "GraphAttributes::change_position_y Node does not have a position");
-    auto& position =
-        std::any_cast<NodePosition&>(mattribute_to_node.at(Attribute::NODES_POSITION).at(node_id));
-    position.y_m = y;
+    m_positions_y[m_nodes_slots.get_index(node_id)] = y;
 }
 
 void GraphAttributes::set_position(const int node_id, const int x, const int y) {
@@ -117,7 +177,12 @@ void GraphAttributes::set_position(const int node_id, const int x, const int y)
     if (!has_attribute(Attribute::NODES_POSITION))
         throw std::runtime_error("GraphAttributes::set_position_x Does not have NODES_POSITION "
                                  "attribute");
-    mattribute_to_node[Attribute::NODES_POSITION][node_id] = NodePosition(x, y);
+    const size_t slot = get_or_add_slot(m_nodes_slots, node_id);
+    grow_column(m_positions_x, m_has_node_position, slot);
+    m_positions_y.resize(m_positions_x.size());
+    m_positions_x[slot] = x;
+    m_positions_y[slot] = y;
+    m_has_node_position[slot] = true;
 }
 
 int GraphAttributes::get_position_x(const int node_id) const {
@@ -128,8 +193,7 @@ int GraphAttributes::get_position_x(const int node_id) const {
         std::cout << node_id << std::endl;
         throw std::runtime_error("GraphAttributes::get_position_x Node does not have a position");
     }
-    return std::any_cast<NodePosition>(mattribute_to_node.at(Attribute::NODES_POSITION).at(node_id))
-        .x_m;
+    return m_positions_x[m_nodes_slots.get_index(node_id)];
 }
 
 int GraphAttributes::get_position_y(const int node_id) const {
@@ -138,15 +202,14 @@ int GraphAttributes::get_position_y(const int node_id) const {
                                  "attribute");
     if (!has_position(node_id))
         throw std::runtime_error("GraphAttributes::get_position_y Node does not have a position");
-    return std::any_cast<NodePosition>(mattribute_to_node.at(Attribute::NODES_POSITION).at(node_id))
-        .y_m;
+    return m_positions_y[m_nodes_slots.get_index(node_id)];
 }
 
 bool GraphAttributes::has_position(const int node_id) const {
     if (!has_attribute(Attribute::NODES_POSITION))
         throw std::runtime_error("GraphAttributes::has_position Does not have NODES_POSITION "
                                  "attribute");
-    return mattribute_to_node.at(Attribute::NODES_POSITION).contains(node_id);
+    return is_in_column(m_nodes_slots, m_has_node_position, node_id);
 }
 
 void GraphAttributes::remove_position(const int node_id) {
@@ -155,5 +218,5 @@ void GraphAttributes::remove_position(const int node_id) {
                                  "attribute");
     if (!has_position(node_id))
         throw std::runtime_error("NodesPositions::remove_position Node does not have a position");
-    mattribute_to_node.at(Attribute::NODES_POSITION).erase(node_id);
-}
\ No newline at end of file
+    m_has_node_position[m_nodes_slots.get_index(node_id)] = false;
+}
@@ -0,0 +1,36 @@
+#include "core/graph/csr_graph.hpp"
+
+#include <stdexcept>
+
+CsrGraph::CsrGraph(const UndirectedSimpleGraph& graph) : m_is_directed(false) { build(graph); }
+
+CsrGraph::CsrGraph(const DirectedSimpleGraph& graph) : m_is_directed(true) { build(graph); }
+
+void CsrGraph::build(const Graph& graph) {
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    m_node_index.reserve(nodes_ids.size());
+    for (const int node_id : nodes_ids)
+        m_node_index.add_node(node_id);
+    m_offsets.reserve(nodes_ids.size() + 1);
+    m_offsets.push_back(0);
+    const size_t adjacency_size = (m_is_directed ? 1 : 2) * graph.get_number_of_edges();
+    m_neighbors.reserve(adjacency_size);
+    m_edges_ids.reserve(adjacency_size);
+    for (const int node_id : nodes_ids) {
+        for (const GraphEdge& edge : graph.get_edges_of_node(node_id)) {
+            m_neighbors.push_back(get_index(edge.get_to_id()));
+            m_edges_ids.push_back(edge.get_id());
+        }
+        m_offsets.push_back(m_neighbors.size());
+    }
+    m_edges.reserve(graph.get_number_of_edges());
+    for (const GraphEdge& edge : graph.get_edges())
+        m_edges.push_back(
+            {edge.get_id(), get_index(edge.get_from_id()), get_index(edge.get_to_id())});
+}
+
+size_t CsrGraph::get_index(const int node_id) const {
+    if (!has_node(node_id))
+        throw std::runtime_error("CsrGraph::get_index: node not found");
+    return m_node_index.get_index(node_id);
+}
@@ -32,9 +32,9 @@ void Cycle::add_in_between_if_exists(const int node_id_1,
     if (!has_node(node_id_1) || !has_node(node_id_2))
         return;
     if (next_of_node(node_id_1) == node_id_2)
-        insert(node_position(node_id_1), in_between_node_id);
+        m_nodes_ids.insert_before(node_id_2, in_between_node_id);
     else if (next_of_node(node_id_2) == node_id_1)
-        insert(node_position(node_id_2), in_between_node_id);
+        m_nodes_ids.insert_before(node_id_1, in_between_node_id);
 }
 
 int Cycle::operator[](const size_t index) const { return m_nodes_ids[index]; }
@@ -1,8 +1,14 @@
 #include "core/graph/file_loader.hpp"
 
+#include <charconv>
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
+
+#include "core/graph/graph_builder.hpp"
+#include "core/mapped_file.hpp"
 
 std::unique_ptr<UndirectedSimpleGraph> load_graph_from_txt_file(const std::string& filename) {
     auto graph = std::make_unique<UndirectedSimpleGraph>();
@@ -18,6 +24,7 @@ void load_graph_from_txt_file(const std::string& filename, UndirectedSimpleGraph
     std::ifstream infile(filename);
     if (!infile)
         throw std::runtime_error("Could not open file: " + filename);
+    GraphBuilder builder;
     std::string line;
     enum Section { NONE, NODES, EDGES } section = NONE;
     while (std::getline(infile, line)) {
@@ -30,14 +37,83 @@ void load_graph_from_txt_file(const std::string& filename, UndirectedSimpleGraph
             if (section == NODES) {
                 int node_id;
                 if (iss >> node_id)
-                    graph.add_node(node_id);
+                    builder.add_node(node_id);
             } else if (section == EDGES) {
                 int from, to;
                 if (iss >> from >> to)
-                    graph.add_edge(from, to);
+                    builder.add_edge(from, to);
             }
         }
     }
+    builder.finish(graph);
+}
+
+// one call per line (without its '\n') with the section the line is in, the section headers
+// themselves excluded
+template <typename Function> void for_each_section_line(std::string_view text, Function function) {
+    enum class Section { NONE, NODES, EDGES } section = Section::NONE;
+    while (!text.empty()) {
+        const size_t end_of_line = text.find('\n');
+        const std::string_view line = text.substr(0, end_of_line);
+        text.remove_prefix(end_of_line == std::string_view::npos ? text.size() : end_of_line + 1);
+        if (line == "nodes:")
+            section = Section::NODES;
+        else if (line == "edges:")
+            section = Section::EDGES;
+        else if (!line.empty() && section != Section::NONE)
+            function(section == Section::NODES, line);
+    }
+}
+
+// reads an int the way std::istream does: white space skipped, then an optional sign, the rest
+// of the text is left, nullopt if there is no number or it overflows
+std::optional<int> read_int(std::string_view& text) {
+    const auto is_space = [](const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    };
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
+    if (text.size() > 1 && text.front() == '+' && text[1] != '-')
+        text.remove_prefix(1);
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{})
+        return std::nullopt;
+    text.remove_prefix(static_cast<size_t>(end - text.data()));
+    return value;
+}
+
+std::unique_ptr<UndirectedSimpleGraph>
+load_graph_from_mapped_txt_file(const std::string& filename) {
+    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    load_graph_from_mapped_txt_file(filename, *graph);
+    return graph;
+}
+
+void load_graph_from_mapped_txt_file(const std::string& filename, UndirectedSimpleGraph& graph) {
+    if (graph.size() > 0)
+        throw std::runtime_error("Graph is not empty. Please use a new graph.");
+    const MappedFile file(filename);
+    const std::string_view text(file.get_bytes().data(), file.get_bytes().size());
+    size_t number_of_nodes = 0;
+    size_t number_of_edges = 0;
+    for_each_section_line(text, [&](const bool is_node, std::string_view) {
+        (is_node ? number_of_nodes : number_of_edges)++;
+    });
+    GraphBuilder builder(number_of_nodes, number_of_edges);
+    for_each_section_line(text, [&builder](const bool is_node, std::string_view line) {
+        const std::optional<int> first = read_int(line);
+        if (!first.has_value())
+            return;
+        if (is_node) {
+            builder.add_node(*first);
+            return;
+        }
+        const std::optional<int> second = read_int(line);
+        if (second.has_value())
+            builder.add_edge(*first, *second);
+    });
+    builder.finish(graph);
 }
 
 void save_graph_to_file(const UndirectedSimpleGraph& graph, const std::string& filename) {
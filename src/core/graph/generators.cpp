@@ -1,5 +1,9 @@
 #include "core/graph/generators.hpp"
 
+#include <algorithm>
+#include <vector>
+
+#include "core/graph/graph_builder.hpp"
 #include "core/graph/graphs_algorithms.hpp"
 
 std::unique_ptr<UndirectedSimpleGraph>
@@ -9,22 +13,26 @@ generate_connected_random_graph_degree_max_4(const size_t number_of_nodes,
         throw std::runtime_error("Number of edges is too large");
     if (number_of_edges + 1 < number_of_nodes)
         throw std::runtime_error("Number of edges is too small");
-    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphBuilder builder(number_of_nodes, number_of_edges);
     for (size_t i = 0; i < number_of_nodes; ++i)
-        graph->add_node(static_cast<int>(i));
-    size_t added_edges = 0;
-    while (added_edges < number_of_edges) {
+        builder.add_node(static_cast<int>(i));
+    GraphEdgeHashSet added_edges;
+    std::vector<int> degrees(number_of_nodes, 0);
+    while (added_edges.size() < number_of_edges) {
         const int i = rand() % static_cast<int>(number_of_nodes);
         const int j = rand() % static_cast<int>(number_of_nodes);
-        if (i == j || graph->has_edge(i, j))
+        if (i == j || added_edges.contains(std::minmax(i, j)))
             continue;
-        if (graph->get_node_by_id(i).get_degree() >= 4)
+        if (degrees[static_cast<size_t>(i)] >= 4)
             continue;
-        if (graph->get_node_by_id(j).get_degree() >= 4)
+        if (degrees[static_cast<size_t>(j)] >= 4)
             continue;
-        graph->add_edge(i, j);
-        ++added_edges;
+        builder.add_edge(i, j);
+        added_edges.insert(std::minmax(i, j));
+        ++degrees[static_cast<size_t>(i)];
+        ++degrees[static_cast<size_t>(j)];
     }
+    auto graph = builder.finish();
     if (!is_graph_connected(*graph))
         return generate_connected_random_graph_degree_max_4(number_of_nodes, number_of_edges);
     return graph;
@@ -34,18 +42,18 @@ std::unique_ptr<UndirectedSimpleGraph>
 generate_connected_random_graph(const size_t number_of_nodes, const size_t number_of_edges) {
     if (number_of_edges + 1 < number_of_nodes)
         throw std::runtime_error("Number of edges is too small");
-    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphBuilder builder(number_of_nodes, number_of_edges);
     for (int i = 0; i < static_cast<int>(number_of_nodes); ++i)
-        graph->add_node(i);
-    size_t added_edges = 0;
-    while (added_edges < number_of_edges) {
+        builder.add_node(i);
+    GraphEdgeHashSet added_edges;
+    while (added_edges.size() < number_of_edges) {
         int i = rand() % static_cast<int>(number_of_nodes);
         int j = rand() % static_cast<int>(number_of_nodes);
-        if (i == j || graph->has_edge(i, j))
+        if (i == j || !added_edges.insert(std::minmax(i, j)).second)
             continue;
-        graph->add_edge(i, j);
-        ++added_edges;
+        builder.add_edge(i, j);
     }
+    auto graph = builder.finish();
     if (!is_graph_connected(*graph))
         return generate_connected_random_graph(number_of_nodes, number_of_edges);
     return graph;
@@ -56,34 +64,34 @@ std::unique_ptr<UndirectedSimpleGraph> generate_grid_graph(const size_t n, const
     const int num_nodes = 2 * static_cast<int>(n) + 2 * static_cast<int>(m) - 4;
     const int n_int = static_cast<int>(n);
     int m_int = static_cast<int>(m);
-    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphBuilder builder(static_cast<size_t>(num_nodes), static_cast<size_t>(num_nodes) + n + m);
     for (int i = 0; i < num_nodes; ++i)
-        graph->add_node(i);
+        builder.add_node(i);
     for (int i = 0; i < num_nodes - 1; ++i)
-        graph->add_edge(i, i + 1);
-    graph->add_edge(0, num_nodes - 1);
+        builder.add_edge(i, i + 1);
+    builder.add_edge(0, num_nodes - 1);
     for (int i = 1; i < n_int - 1; ++i)
-        graph->add_edge(i, 2 * n_int + m_int - i - 3);
+        builder.add_edge(i, 2 * n_int + m_int - i - 3);
     m_int -= 2;
     for (int i = 0; i < m_int; ++i)
-        graph->add_edge(n_int + i, 2 * n_int + 2 * m_int - i - 1);
-    return graph;
+        builder.add_edge(n_int + i, 2 * n_int + 2 * m_int - i - 1);
+    return builder.finish();
 }
 
 // num_nodes > 1
 std::unique_ptr<UndirectedSimpleGraph> generate_triangle_graph(size_t num_nodes) {
     num_nodes = 3 * num_nodes;
-    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphBuilder builder(num_nodes, 2 * num_nodes);
     for (int i = 0; i < static_cast<int>(num_nodes); ++i)
-        graph->add_node(i);
+        builder.add_node(i);
     for (int i = 0; i < static_cast<int>(num_nodes) - 3; ++i) {
         if (i % 3 == 2) {
-            graph->add_edge(i, i + 3);
-            graph->add_edge(i + 3, i - 2);
+            builder.add_edge(i, i + 3);
+            builder.add_edge(i + 3, i - 2);
         } else {
-            graph->add_edge(i, i + 3);
-            graph->add_edge(i + 1, i + 3);
+            builder.add_edge(i, i + 3);
+            builder.add_edge(i + 1, i + 3);
         }
     }
-    return graph;
+    return builder.finish();
 }
\ No newline at end of file
@@ -40,9 +40,18 @@ const GraphNode& Graph::add_node(const int id) {
     const auto node = new GraphNode(id, *this);
     m_nodeid_to_node_map[id] = std::unique_ptr<GraphNode>(node);
     m_nodeid_to_incident_edgeids[id] = {};
+    m_node_index_map.add_node(id);
     return *node;
 }
 
+// the maps iterated by get_nodes_ids, get_nodes and get_edges keep growing as they did, since
+// their bucket count decides the order of the nodes and edges, and so the drawings
+void Graph::reserve(const size_t number_of_nodes, const size_t number_of_edges) {
+    m_nodeid_to_incident_edgeids.reserve(number_of_nodes);
+    m_node_index_map.reserve(number_of_nodes);
+    m_edge_to_edgeids.reserve(number_of_edges);
+}
+
 const GraphNode& Graph::get_node_by_id(const int id) const {
     if (!has_node(id))
         throw std::runtime_error("Graph::get_node_by_id: node not found");
@@ -70,6 +79,12 @@ std::vector<GraphEdge> Graph::get_edges_of_node(const int node_id) const {
     return edges;
 }
 
+const std::unordered_set<int>& Graph::get_adjacent_edgeids(const int node_id) const {
+    if (!has_node(node_id))
+        throw std::runtime_error("Graph::get_adjacent_edgeids: node not found");
+    return m_nodeid_to_incident_edgeids.at(node_id);
+}
+
 std::vector<GraphEdge> Graph::get_edges() const {
     std::vector<GraphEdge> edges;
     for (const auto& edge : m_edgeid_to_edge_map | std::views::values)
@@ -88,10 +103,12 @@ int Graph::add_edge(const int from_id, const int to_id) {
         throw std::runtime_error("Graph::add_edge: [from node] not found");
     if (!has_node(to_id))
         throw std::runtime_error("Graph::add_edge: [to node] not found");
-    const GraphNode& from_node = get_node_by_id(from_id);
-    const GraphNode& to_node = get_node_by_id(to_id);
+    return add_edge_unchecked(from_id, to_id);
+}
+
+int Graph::add_edge_unchecked(const int from_id, const int to_id) {
     const int edge_id = m_next_edge_id++;
-    m_edgeid_to_edge_map[edge_id] = std::make_unique<GraphEdge>(edge_id, from_node, to_node);
+    m_edgeid_to_edge_map[edge_id] = std::make_unique<GraphEdge>(edge_id, from_id, to_id);
     m_nodeid_to_incident_edgeids[from_id].insert(edge_id);
     m_nodeid_to_incident_edgeids[to_id].insert(edge_id);
     m_total_edges++;
@@ -124,6 +141,7 @@ void Graph::remove_node(const int node_id) {
         remove_edge(edge_id);
     m_nodeid_to_node_map.erase(node_id);
     m_nodeid_to_incident_edgeids.erase(node_id);
+    m_node_index_map.remove_node(node_id);
 }
 
 size_t Graph::size() const { return m_nodeid_to_node_map.size(); }
@@ -159,12 +177,12 @@ int GraphNode::get_id() const { return m_id; }
 
 std::string GraphNode::to_string() const {
     std::string result = "Node " + std::to_string(m_id) + " neighbors:";
-    for (const GraphEdge& edge : get_edges())
-        result += " " + std::to_string(edge.get_to_id());
+    for (const GraphNeighbor neighbor : get_neighbors())
+        result += " " + std::to_string(neighbor.id);
     return result;
 }
 
-size_t GraphNode::get_degree() const { return get_edges().size(); }
+size_t GraphNode::get_degree() const { return m_graph_owner.get_degree_of_node(m_id); }
 
 const Graph& GraphNode::get_owner() const { return m_graph_owner; }
 
@@ -175,6 +193,12 @@ const GraphNode& DirectedMultiGraph::add_node(const int node_id) {
     return node;
 }
 
+void DirectedMultiGraph::reserve(const size_t number_of_nodes, const size_t number_of_edges) {
+    Graph::reserve(number_of_nodes, number_of_edges);
+    m_nodeid_to_incoming_edgeids.reserve(number_of_nodes);
+    m_nodeid_to_outgoing_edgeids.reserve(number_of_nodes);
+}
+
 int DirectedMultiGraph::add_edge(const int from_id, const int to_id) {
     const int edge_id = Graph::add_edge(from_id, to_id);
     m_nodeid_to_incoming_edgeids[to_id].insert(edge_id);
@@ -200,6 +224,12 @@ std::vector<GraphEdge> DirectedMultiGraph::get_in_edges_of_node(const int node_i
     return edges;
 }
 
+const std::unordered_set<int>& DirectedMultiGraph::get_adjacent_edgeids(const int node_id) const {
+    if (!has_node(node_id))
+        throw std::runtime_error("DirectedMultiGraph::get_adjacent_edgeids: node not found");
+    return m_nodeid_to_outgoing_edgeids.at(node_id);
+}
+
 size_t DirectedMultiGraph::get_in_degree_of_node(const int node_id) const {
     return m_nodeid_to_incoming_edgeids.at(node_id).size();
 }
@@ -215,10 +245,10 @@ void DirectedMultiGraph::remove_node(const int node_id) {
 }
 
 void DirectedMultiGraph::remove_edge(const int edge_id) {
-    Graph::remove_edge(edge_id);
     const GraphEdge& edge = get_edge_by_id(edge_id);
     m_nodeid_to_incoming_edgeids[edge.get_to_id()].erase(edge_id);
     m_nodeid_to_outgoing_edgeids[edge.get_from_id()].erase(edge_id);
+    Graph::remove_edge(edge_id);
 }
 
 bool DirectedMultiGraph::has_edge(const int from_id, const int to_id) const {
@@ -246,7 +276,7 @@ GraphEdge DirectedSimpleGraph::get_edge(const int from_id, const int to_id) cons
 }
 
 size_t UndirectedMultiGraph::get_degree_of_node(const int node_id) const {
-    return get_edges_of_node(node_id).size();
+    return get_adjacent_edgeids(node_id).size();
 }
 
 bool UndirectedMultiGraph::has_edge(const int from_id, const int to_id) const {
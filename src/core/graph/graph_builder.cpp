@@ -0,0 +1,72 @@
+#include "core/graph/graph_builder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+GraphBuilder::GraphBuilder(const size_t number_of_nodes, const size_t number_of_edges) {
+    reserve(number_of_nodes, number_of_edges);
+}
+
+void GraphBuilder::reserve(const size_t number_of_nodes, const size_t number_of_edges) {
+    m_nodes_ids.reserve(number_of_nodes);
+    m_edges.reserve(number_of_edges);
+}
+
+void GraphBuilder::add_node(const int node_id) { m_nodes_ids.push_back(node_id); }
+
+void GraphBuilder::add_nodes(const std::span<const int> nodes_ids) {
+    m_nodes_ids.insert(m_nodes_ids.end(), nodes_ids.begin(), nodes_ids.end());
+}
+
+void GraphBuilder::add_edge(const int from_id, const int to_id) {
+    m_edges.emplace_back(from_id, to_id);
+}
+
+void GraphBuilder::add_edges(const std::span<const std::pair<int, int>> edges) {
+    m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+}
+
+size_t GraphBuilder::get_number_of_nodes() const { return m_nodes_ids.size(); }
+
+size_t GraphBuilder::get_number_of_edges() const { return m_edges.size(); }
+
+std::unique_ptr<UndirectedSimpleGraph> GraphBuilder::finish() {
+    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    finish(*graph);
+    return graph;
+}
+
+// throws what add_edge would throw for an invalid edge, the edges repeated among the new ones are
+// found by sorting them with their smaller endpoint first; the nodes are looked up in the dense
+// index of the graph instead of its node map
+void check_edges(const UndirectedSimpleGraph& graph,
+                 const std::vector<std::pair<int, int>>& edges) {
+    std::vector<std::pair<int, int>> sorted_edges;
+    sorted_edges.reserve(edges.size());
+    const bool graph_has_edges = graph.get_number_of_edges() > 0;
+    const NodeIndexMap& node_index_map = graph.get_node_index_map();
+    for (const auto& [from_id, to_id] : edges) {
+        if (node_index_map.find_index(from_id) == NodeIndexMap::NO_INDEX)
+            throw std::runtime_error("Graph::add_edge: [from node] not found");
+        if (node_index_map.find_index(to_id) == NodeIndexMap::NO_INDEX)
+            throw std::runtime_error("Graph::add_edge: [to node] not found");
+        if (graph_has_edges && graph.has_edge(from_id, to_id))
+            throw std::runtime_error("UndirectedSimpleGraph::add_edge: edge already exists");
+        sorted_edges.push_back(std::minmax(from_id, to_id));
+    }
+    std::ranges::sort(sorted_edges);
+    if (std::ranges::adjacent_find(sorted_edges) != sorted_edges.end())
+        throw std::runtime_error("UndirectedSimpleGraph::add_edge: edge already exists");
+}
+
+// only the edges are reserved for, the nodes go in as consecutive add_node calls would add them
+void GraphBuilder::finish(UndirectedSimpleGraph& graph) {
+    graph.reserve(graph.size(), graph.get_number_of_edges() + m_edges.size());
+    for (const int node_id : m_nodes_ids)
+        graph.add_node(node_id);
+    check_edges(graph, m_edges);
+    for (const auto& [from_id, to_id] : m_edges)
+        graph.add_edge_unchecked(from_id, to_id);
+    m_nodes_ids.clear();
+    m_edges.clear();
+}
@@ -10,28 +10,31 @@
 #include <unordered_set>
 #include <utility>
 
-#include "core/tree/tree.hpp"
-#include "core/tree/tree_algorithms.hpp"
+#include "core/graph/graph_builder.hpp"
 
 bool is_graph_connected(const UndirectedSimpleGraph& graph) {
+    return is_graph_connected(CsrGraph(graph));
+}
+
+bool is_graph_connected(const CsrGraph& graph) {
     if (graph.size() == 0)
         return true;
-    std::unordered_set<int> visited;
-    std::vector<int> stack;
-    stack.push_back(graph.get_nodes_ids()[0]);
+    std::vector<bool> visited(graph.size(), false);
+    std::vector<size_t> stack;
+    stack.push_back(0);
+    size_t visited_count = 0;
     while (!stack.empty()) {
-        const int node_id = stack.back();
+        const size_t node = stack.back();
         stack.pop_back();
-        const GraphNode& node = graph.get_node_by_id(node_id);
-        visited.insert(node.get_id());
-        for (const GraphEdge& edge : node.get_edges())
-            if (!visited.contains(edge.get_to_id()))
-                stack.push_back(edge.get_to_id());
+        if (visited[node])
+            continue;
+        visited[node] = true;
+        ++visited_count;
+        for (const size_t neighbor : graph.get_neighbors(node))
+            if (!visited[neighbor])
+                stack.push_back(neighbor);
     }
-    for (const int node_id : graph.get_nodes_ids())
-        if (!visited.contains(node_id))
-            return false;
-    return true;
+    return visited_count == graph.size();
 }
 
 std::vector<Cycle>
@@ -75,105 +78,153 @@ std::vector<Cycle> compute_all_cycles_in_graph(const UndirectedSimpleGraph& grap
     return all_cycles;
 }
 
-bool dfs_find_cycle(const GraphNode& node,
-                    const DirectedSimpleGraph& graph,
-                    std::unordered_map<int, int>& state,
-                    std::unordered_map<int, int>& parent,
-                    std::optional<int>& cycle_start,
-                    std::optional<int>& cycle_end) {
-    state[node.get_id()] = 1; // mark as visiting (gray)
-    for (const GraphEdge& edge : node.get_edges()) {
-        const int neighbor_id = edge.get_to_id();
-        const GraphNode& neighbor = graph.get_node_by_id(neighbor_id);
-        if (!state.contains(neighbor.get_id())) { // unvisited
-            parent[neighbor.get_id()] = node.get_id();
-            if (dfs_find_cycle(neighbor, graph, state, parent, cycle_start, cycle_end))
-                return true;
-        } else if (state[neighbor.get_id()] == 1) {
-            cycle_start = neighbor.get_id();
-            cycle_end = node.get_id();
-            return true;
+std::optional<Cycle> find_a_cycle_in_graph(const DirectedSimpleGraph& graph) {
+    std::vector<Cycle> cycles = find_disjoint_cycles_in_graph(CsrGraph(graph), 1);
+    if (cycles.empty())
+        return std::nullopt;
+    return std::move(cycles.front());
+}
+
+std::vector<Cycle> find_disjoint_cycles_in_graph(const DirectedSimpleGraph& graph,
+                                                 const size_t max_number_of_cycles) {
+    return find_disjoint_cycles_in_graph(CsrGraph(graph), max_number_of_cycles);
+}
+
+std::vector<Cycle> find_disjoint_cycles_in_graph(const CsrGraph& graph,
+                                                 const size_t max_number_of_cycles) {
+    enum class State : unsigned char { UNVISITED, ON_STACK, DONE };
+    std::vector<State> state(graph.size(), State::UNVISITED);
+    // explicit stack of (node, next neighbor to visit), same visiting order of a recursive dfs
+    std::vector<std::pair<size_t, size_t>> stack;
+    std::vector<Cycle> cycles;
+    for (size_t root = 0; root < graph.size(); ++root) {
+        if (state[root] != State::UNVISITED)
+            continue;
+        state[root] = State::ON_STACK;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            const size_t node = stack.back().first;
+            const std::span<const size_t> neighbors = graph.get_neighbors(node);
+            if (stack.back().second == neighbors.size()) {
+                state[node] = State::DONE;
+                stack.pop_back();
+                continue;
+            }
+            const size_t neighbor = neighbors[stack.back().second++];
+            if (state[neighbor] == State::UNVISITED) {
+                state[neighbor] = State::ON_STACK;
+                stack.emplace_back(neighbor, 0);
+                continue;
+            }
+            if (state[neighbor] == State::DONE)
+                continue;
+            // back edge, the cycle is the part of the stack from neighbor up to node, its nodes
+            // are closed so that the next cycles are disjoint from it
+            std::vector<int> cycle;
+            while (true) {
+                const size_t cycle_node = stack.back().first;
+                cycle.push_back(graph.get_node_id(cycle_node));
+                state[cycle_node] = State::DONE;
+                stack.pop_back();
+                if (cycle_node == neighbor)
+                    break;
+            }
+            std::ranges::reverse(cycle);
+            cycles.emplace_back(cycle);
+            if (cycles.size() == max_number_of_cycles)
+                return cycles;
         }
     }
-    state[node.get_id()] = 2; // mark as fully processed (black)
-    return false;
+    return cycles;
 }
 
-std::optional<Cycle> find_a_cycle_in_graph(const DirectedSimpleGraph& graph) {
-    std::unordered_map<int, int> state;
-    std::unordered_map<int, int> parent;
-    std::optional<int> cycle_start = std::nullopt;
-    std::optional<int> cycle_end = std::nullopt;
-    for (const GraphNode* node : graph.get_nodes())
-        if (!state.contains(node->get_id()))
-            if (dfs_find_cycle(*node, graph, state, parent, cycle_start, cycle_end))
-                break;
-    if (!cycle_start.has_value())
-        return std::nullopt;
-    std::vector<int> cycle;
-    for (int v = cycle_end.value(); v != cycle_start; v = parent[v])
-        cycle.push_back(v);
-    cycle.push_back(cycle_start.value());
-    std::ranges::reverse(cycle.begin(), cycle.end());
-    return Cycle(cycle);
+std::vector<Cycle> compute_cycle_basis(const UndirectedSimpleGraph& graph) {
+    return compute_cycle_basis(CsrGraph(graph));
 }
 
-std::vector<Cycle> compute_cycle_basis(const UndirectedSimpleGraph& graph) {
-    const std::unique_ptr<Tree> spanning = build_spanning_tree(graph);
+std::vector<Cycle> compute_cycle_basis(const CsrGraph& graph) {
+    if (graph.size() == 0)
+        return {};
+    // breadth first spanning tree rooted in the first node
+    std::vector<size_t> parent(graph.size(), CsrGraph::NO_INDEX);
+    std::vector<size_t> depth(graph.size(), 0);
+    std::vector<bool> visited(graph.size(), false);
+    std::vector<size_t> queue;
+    queue.reserve(graph.size());
+    queue.push_back(0);
+    visited[0] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const size_t node = queue[head];
+        for (const size_t neighbor : graph.get_neighbors(node)) {
+            if (visited[neighbor])
+                continue;
+            visited[neighbor] = true;
+            parent[neighbor] = node;
+            depth[neighbor] = depth[node] + 1;
+            queue.push_back(neighbor);
+        }
+    }
+    if (queue.size() != graph.size())
+        throw std::runtime_error("Graph is not connected");
     std::vector<Cycle> cycles;
-    for (const GraphNode* node : graph.get_nodes()) {
-        const int node_id = node->get_id();
-        for (const GraphEdge& edge : node->get_edges()) {
-            const int neighbor_id = edge.get_to_id();
-            if (node_id > neighbor_id)
+    std::vector<int> path_to_ancestor;
+    for (size_t node = 0; node < graph.size(); ++node) {
+        const int node_id = graph.get_node_id(node);
+        for (const size_t neighbor : graph.get_neighbors(node)) {
+            if (node_id > graph.get_node_id(neighbor))
                 continue;
-            if (spanning->has_edge(node_id, neighbor_id))
+            if (parent[node] == neighbor || parent[neighbor] == node)
                 continue;
-            int common_ancestor = compute_common_ancestor(*spanning, node_id, neighbor_id);
-            std::vector<int> path1 = get_path_from_root(*spanning, node_id);
-            std::vector<int> path2 = get_path_from_root(*spanning, neighbor_id);
-            std::ranges::reverse(path1.begin(), path1.end());
-            std::ranges::reverse(path2.begin(), path2.end());
-            while (path1.back() != common_ancestor)
-                path1.pop_back();
-            while (path2.back() != common_ancestor)
-                path2.pop_back();
-            std::ranges::reverse(path1.begin(), path1.end());
-            path1.insert(path1.end(), path2.begin(), path2.end());
-            path1.pop_back();
-            cycles.emplace_back(path1);
+            // the cycle goes from the common ancestor down to node, then from neighbor back up
+            std::vector<int> cycle;
+            path_to_ancestor.clear();
+            size_t up_1 = node;
+            size_t up_2 = neighbor;
+            while (depth[up_1] > depth[up_2]) {
+                cycle.push_back(graph.get_node_id(up_1));
+                up_1 = parent[up_1];
+            }
+            while (depth[up_2] > depth[up_1]) {
+                path_to_ancestor.push_back(graph.get_node_id(up_2));
+                up_2 = parent[up_2];
+            }
+            while (up_1 != up_2) {
+                cycle.push_back(graph.get_node_id(up_1));
+                path_to_ancestor.push_back(graph.get_node_id(up_2));
+                up_1 = parent[up_1];
+                up_2 = parent[up_2];
+            }
+            cycle.push_back(graph.get_node_id(up_1));
+            std::ranges::reverse(cycle);
+            cycle.insert(cycle.end(), path_to_ancestor.begin(), path_to_ancestor.end());
+            cycles.emplace_back(cycle);
         }
     }
     return cycles;
 }
 
 std::vector<int> make_topological_ordering(const DirectedSimpleGraph& graph) {
-    std::unordered_map<int, int> in_degree;
+    const NodeIndexMap& index_map = graph.get_node_index_map();
+    std::vector<int> in_degree(graph.size(), 0);
     const std::vector<const GraphNode*> nodes = graph.get_nodes();
-    for (const GraphNode* node : nodes) {
-        for (const GraphEdge& edge : node->get_edges()) {
-            const GraphNode& neighbor = graph.get_node_by_id(edge.get_to_id());
-            if (!in_degree.contains(neighbor.get_id()))
-                in_degree[neighbor.get_id()] = 0;
-            in_degree[neighbor.get_id()]++;
-        }
-    }
-    std::queue<const GraphNode*> queue;
+    for (const GraphNode* node : nodes)
+        for (const GraphNeighbor neighbor : node->get_neighbors())
+            in_degree[index_map.get_index(neighbor.id)]++;
+    std::queue<int> queue;
     std::vector<int> topological_order;
+    topological_order.reserve(graph.size());
     for (const GraphNode* node : nodes)
-        if (in_degree[node->get_id()] == 0)
-            queue.push(node);
+        if (in_degree[index_map.get_index(node->get_id())] == 0)
+            queue.push(node->get_id());
     size_t count = 0;
     while (!queue.empty()) {
-        const GraphNode* node = queue.front();
+        const int node_id = queue.front();
         ++count;
         queue.pop();
-        topological_order.push_back(node->get_id());
-        for (const GraphEdge& edge : node->get_edges()) {
-            const GraphNode& neighbor = graph.get_node_by_id(edge.get_to_id());
-            if (--in_degree[neighbor.get_id()] == 0)
-                queue.push(&neighbor);
-        }
+        topological_order.push_back(node_id);
+        for (const GraphNeighbor neighbor : graph.get_neighbors(node_id))
+            if (--in_degree[index_map.get_index(neighbor.id)] == 0)
+                queue.push(neighbor.id);
     }
     if (count != graph.size())
         throw std::runtime_error("Graph contains cycle");
@@ -209,15 +260,18 @@ bool are_cycles_equivalent(const Cycle& cycle1, const Cycle& cycle2) {
 std::vector<std::unique_ptr<UndirectedSimpleGraph>>
 compute_connected_components(const UndirectedSimpleGraph& graph) {
     std::unordered_set<int> visited;
+    // nodes and edges already in some component
+    std::unordered_set<int> added_nodes;
+    std::unordered_set<int> added_edges;
     std::vector<std::unique_ptr<UndirectedSimpleGraph>> components;
-    std::function<void(const GraphNode&, UndirectedSimpleGraph& component)> explore_component =
-        [&](const GraphNode& node, UndirectedSimpleGraph& component) {
+    std::function<void(const GraphNode&, GraphBuilder& component)> explore_component =
+        [&](const GraphNode& node, GraphBuilder& component) {
             visited.insert(node.get_id());
             for (const GraphEdge& edge : node.get_edges()) {
                 const GraphNode& neighbor = graph.get_node_by_id(edge.get_to_id());
-                if (!component.has_node(neighbor.get_id()))
+                if (added_nodes.insert(neighbor.get_id()).second)
                     component.add_node(neighbor.get_id());
-                if (!component.has_edge(node.get_id(), neighbor.get_id()))
+                if (added_edges.insert(edge.get_id()).second)
                     component.add_edge(node.get_id(), neighbor.get_id());
                 if (!visited.contains(neighbor.get_id())) {
                     explore_component(neighbor, component);
@@ -226,10 +280,11 @@ compute_connected_components(const UndirectedSimpleGraph& graph) {
         };
     for (const GraphNode* node : graph.get_nodes())
         if (!visited.contains(node->get_id())) {
-            auto new_component = std::make_unique<UndirectedSimpleGraph>();
-            new_component->add_node(node->get_id());
-            explore_component(*node, *new_component);
-            components.push_back(std::move(new_component));
+            GraphBuilder new_component;
+            added_nodes.insert(node->get_id());
+            new_component.add_node(node->get_id());
+            explore_component(*node, new_component);
+            components.push_back(new_component.finish());
         }
     return components;
 }
@@ -260,122 +315,101 @@ size_t compute_number_of_connected_components(const UndirectedSimpleGraph& graph
     return components;
 }
 
-void dfs_bic_com(const UndirectedSimpleGraph& graph,
-                 const GraphNode& node,
-                 std::unordered_map<int, int>& old_node_id_to_new_id,
-                 std::unordered_map<int, int>& prev_of_node,
-                 int& next_id_to_assign,
-                 std::unordered_map<int, int>& low_point,
-                 std::list<int>& stack_of_nodes,
-                 std::list<std::pair<int, int>>& stack_of_edges,
-                 std::vector<std::unique_ptr<UndirectedSimpleGraph>>& components,
-                 std::unordered_set<int>& cut_vertices);
-
-BiconnectedComponents compute_biconnected_components(const UndirectedSimpleGraph& graph) {
-    std::unordered_map<int, int> old_node_id_to_new_id;
-    std::unordered_map<int, int> prev_of_node;
-    std::unordered_map<int, int> low_point;
-    std::unordered_set<int> cut_vertices;
-    std::vector<std::unique_ptr<UndirectedSimpleGraph>> components;
-    int next_id_to_assign = 0;
-    std::list<int> stack_of_nodes{};
-    std::list<std::pair<int, int>> stack_of_edges{};
-    for (const GraphNode* node : graph.get_nodes())
-        if (!old_node_id_to_new_id.contains(node->get_id())) // node not visited
-            dfs_bic_com(graph,
-                        *node,
-                        old_node_id_to_new_id,
-                        prev_of_node,
-                        next_id_to_assign,
-                        low_point,
-                        stack_of_nodes,
-                        stack_of_edges,
-                        components,
-                        cut_vertices);
-    if (!stack_of_nodes.empty() || !stack_of_edges.empty())
-        throw std::runtime_error("Biconnected components algorithm did not finish correctly");
-    BiconnectedComponents result{std::move(cut_vertices), std::move(components)};
-    return result;
-}
-
 void build_component(UndirectedSimpleGraph& component,
                      const std::list<int>& nodes,
                      const std::list<std::pair<int, int>>& edges) {
+    GraphBuilder builder(nodes.size(), edges.size());
     for (const int node : nodes)
-        component.add_node(node);
+        builder.add_node(node);
     for (const auto& [from_id, to_id] : edges)
-        component.add_edge(from_id, to_id);
+        builder.add_edge(from_id, to_id);
+    builder.finish(component);
 }
 
-void dfs_bic_com(const UndirectedSimpleGraph& graph,
-                 const GraphNode& node,
-                 std::unordered_map<int, int>& old_node_id_to_new_id,
-                 std::unordered_map<int, int>& prev_of_node,
-                 int& next_id_to_assign,
-                 std::unordered_map<int, int>& low_point,
+struct BiconnectedDfsState {
+    std::vector<int> discovery;
+    std::vector<size_t> prev_of_node;
+    std::vector<int> low_point;
+    int next_id_to_assign = 0;
+    std::vector<std::unique_ptr<UndirectedSimpleGraph>> components;
+    std::unordered_set<int> cut_vertices;
+};
+
+void dfs_bic_com(const CsrGraph& graph,
+                 const size_t node,
+                 BiconnectedDfsState& state,
                  std::list<int>& stack_of_nodes,
-                 std::list<std::pair<int, int>>& stack_of_edges,
-                 std::vector<std::unique_ptr<UndirectedSimpleGraph>>& components,
-                 std::unordered_set<int>& cut_vertices) {
-    int node_id = node.get_id();
-    old_node_id_to_new_id[node_id] = next_id_to_assign;
-    low_point[node_id] = next_id_to_assign;
-    ++next_id_to_assign;
+                 std::list<std::pair<int, int>>& stack_of_edges) {
+    const int node_id = graph.get_node_id(node);
+    state.discovery[node] = state.next_id_to_assign;
+    state.low_point[node] = state.next_id_to_assign;
+    ++state.next_id_to_assign;
     int children_number = 0;
-    for (const GraphEdge& edge : node.get_edges()) {
-        const GraphNode& neighbor = graph.get_node_by_id(edge.get_to_id());
-        const int neighbor_id = neighbor.get_id();
-        if (prev_of_node.contains(node_id) && prev_of_node[node_id] == neighbor_id)
+    const bool is_root = state.prev_of_node[node] == CsrGraph::NO_INDEX;
+    for (const size_t neighbor : graph.get_neighbors(node)) {
+        const int neighbor_id = graph.get_node_id(neighbor);
+        if (state.prev_of_node[node] == neighbor)
             continue;
-        if (!old_node_id_to_new_id.contains(neighbor_id)) { // means the node is not visited
+        if (state.discovery[neighbor] == -1) { // means the node is not visited
             std::list<int> new_stack_of_nodes{};
             std::list<std::pair<int, int>> new_stack_of_edges{};
             ++children_number;
-            prev_of_node[neighbor_id] = node_id;
+            state.prev_of_node[neighbor] = node;
             new_stack_of_nodes.push_back(neighbor_id);
             new_stack_of_edges.emplace_back(node_id, neighbor_id);
-            dfs_bic_com(graph,
-                        neighbor,
-                        old_node_id_to_new_id,
-                        prev_of_node,
-                        next_id_to_assign,
-                        low_point,
-                        new_stack_of_nodes,
-                        new_stack_of_edges,
-                        components,
-                        cut_vertices);
-            if (low_point[neighbor_id] < low_point[node_id])
-                low_point[node_id] = low_point[neighbor_id];
-            if (low_point[neighbor_id] >= old_node_id_to_new_id[node_id]) {
+            dfs_bic_com(graph, neighbor, state, new_stack_of_nodes, new_stack_of_edges);
+            if (state.low_point[neighbor] < state.low_point[node])
+                state.low_point[node] = state.low_point[neighbor];
+            if (state.low_point[neighbor] >= state.discovery[node]) {
                 new_stack_of_nodes.push_back(node_id);
-                components.push_back(std::make_unique<UndirectedSimpleGraph>());
-                build_component(*components.back(), new_stack_of_nodes, new_stack_of_edges);
-                if (prev_of_node.contains(node_id)) // the root needs to be handled differently
+                state.components.push_back(std::make_unique<UndirectedSimpleGraph>());
+                build_component(*state.components.back(), new_stack_of_nodes, new_stack_of_edges);
+                if (!is_root) // the root needs to be handled differently
                     // (handled at the end of the function)
-                    cut_vertices.insert(node_id);
+                    state.cut_vertices.insert(node_id);
             } else {
                 stack_of_nodes.splice(stack_of_nodes.end(), new_stack_of_nodes);
                 stack_of_edges.splice(stack_of_edges.end(), new_stack_of_edges);
             }
         } else { // node got already visited
-            const int neighbor_node_id = old_node_id_to_new_id[neighbor_id];
-            if (neighbor_node_id < old_node_id_to_new_id[node_id]) {
+            const int neighbor_discovery = state.discovery[neighbor];
+            if (neighbor_discovery < state.discovery[node]) {
                 stack_of_edges.emplace_back(node_id, neighbor_id);
-                if (neighbor_node_id < low_point[node_id])
-                    low_point[node_id] = neighbor_node_id;
+                if (neighbor_discovery < state.low_point[node])
+                    state.low_point[node] = neighbor_discovery;
             }
         }
     }
-    if (!prev_of_node.contains(node_id)) { // handling of node with no parents (the root)
+    if (is_root) { // handling of node with no parents (the root)
         if (children_number >= 2)
-            cut_vertices.insert(node_id);
+            state.cut_vertices.insert(node_id);
         else if (children_number == 0) { // node is isolated
-            components.push_back(std::make_unique<UndirectedSimpleGraph>());
-            components.back()->add_node(node_id);
+            state.components.push_back(std::make_unique<UndirectedSimpleGraph>());
+            state.components.back()->add_node(node_id);
         }
     }
 }
 
+BiconnectedComponents compute_biconnected_components(const UndirectedSimpleGraph& graph) {
+    return compute_biconnected_components(CsrGraph(graph));
+}
+
+BiconnectedComponents compute_biconnected_components(const CsrGraph& graph) {
+    BiconnectedDfsState state;
+    state.discovery.assign(graph.size(), -1);
+    state.prev_of_node.assign(graph.size(), CsrGraph::NO_INDEX);
+    state.low_point.assign(graph.size(), 0);
+    std::list<int> stack_of_nodes{};
+    std::list<std::pair<int, int>> stack_of_edges{};
+    for (size_t node = 0; node < graph.size(); ++node)
+        if (state.discovery[node] == -1) // node not visited
+            dfs_bic_com(graph, node, state, stack_of_nodes, stack_of_edges);
+    if (!stack_of_nodes.empty() || !stack_of_edges.empty())
+        throw std::runtime_error("Biconnected components algorithm did not finish correctly");
+    BiconnectedComponents result{std::move(state.cut_vertices), std::move(state.components)};
+    return result;
+}
+
 std::string BiconnectedComponents::to_string() const {
     std::string result = "Biconnected Components:\n";
     result += "Cut vertices: ";
@@ -415,22 +449,24 @@ compute_maximal_degree_4_subgraph(const UndirectedSimpleGraph& graph) {
     return std::make_pair(std::move(subgraph), std::move(removed_edges));
 }
 
+// side is -1 for nodes not reached yet, 0 or 1 otherwise
 bool bfs_bipartition(const UndirectedSimpleGraph& graph,
-                     const GraphNode& node,
-                     std::unordered_map<int, bool>& bipartition) {
-    bipartition[node.get_id()] = false;
-    std::list<const GraphNode*> queue;
-    queue.push_back(&node);
+                     const int node_id,
+                     std::vector<signed char>& side) {
+    const NodeIndexMap& index_map = graph.get_node_index_map();
+    side[index_map.get_index(node_id)] = 0;
+    std::queue<int> queue;
+    queue.push(node_id);
     while (!queue.empty()) {
-        const GraphNode& current = *queue.front();
-        const int current_id = current.get_id();
-        queue.pop_front();
-        for (const GraphEdge& edge : current.get_edges()) {
-            const int neighbor_id = edge.get_to_id();
-            if (!bipartition.contains(neighbor_id)) {
-                bipartition[neighbor_id] = !bipartition[current_id];
-                queue.push_back(&graph.get_node_by_id(edge.get_to_id()));
-            } else if (bipartition[neighbor_id] == bipartition[current_id])
+        const int current_id = queue.front();
+        const signed char current_side = side[index_map.get_index(current_id)];
+        queue.pop();
+        for (const GraphNeighbor neighbor : graph.get_neighbors(current_id)) {
+            const size_t neighbor_index = index_map.get_index(neighbor.id);
+            if (side[neighbor_index] == -1) {
+                side[neighbor_index] = current_side == 0 ? 1 : 0;
+                queue.push(neighbor.id);
+            } else if (side[neighbor_index] == current_side)
                 return false;
         }
     }
@@ -439,58 +475,67 @@ bool bfs_bipartition(const UndirectedSimpleGraph& graph,
 
 std::optional<std::unordered_map<int, bool>>
 compute_bipartition(const UndirectedSimpleGraph& graph) {
-    std::unordered_map<int, bool> bipartition{};
+    const NodeIndexMap& index_map = graph.get_node_index_map();
+    std::vector<signed char> side(graph.size(), -1);
     for (const GraphNode* node : graph.get_nodes())
-        if (!bipartition.contains(node->get_id()))
-            if (!bfs_bipartition(graph, *node, bipartition))
+        if (side[index_map.get_index(node->get_id())] == -1)
+            if (!bfs_bipartition(graph, node->get_id(), side))
                 return std::nullopt;
+    std::unordered_map<int, bool> bipartition{};
+    for (size_t index = 0; index < index_map.size(); ++index)
+        bipartition[index_map.get_node_id(index)] = side[index] == 1;
     return bipartition;
 }
 
 std::optional<Cycle> find_a_cycle_in_graph(const UndirectedSimpleGraph& graph) {
     if (graph.size() <= 2)
         return std::nullopt;
-    std::unordered_set<int> visited;
-    std::unordered_map<int, int> parent;
+    const NodeIndexMap& index_map = graph.get_node_index_map();
+    std::vector<bool> visited(graph.size(), false);
+    std::vector<int> parent(graph.size(), -1);
+    const auto has_parent = [&](const int node_id) {
+        return parent[index_map.get_index(node_id)] != -1;
+    };
+    const auto parent_of = [&](const int node_id) { return parent[index_map.get_index(node_id)]; };
     for (const GraphNode* start_node : graph.get_nodes()) {
         const int start_id = start_node->get_id();
-        if (visited.contains(start_id))
+        if (visited[index_map.get_index(start_id)])
             continue;
-        std::vector<const GraphNode*> stack;
-        stack.push_back(start_node);
+        std::vector<int> stack;
+        stack.push_back(start_id);
         while (!stack.empty()) {
-            const GraphNode& current = *stack.back();
+            const int current_id = stack.back();
             stack.pop_back();
-            int current_id = current.get_id();
-            visited.insert(current_id);
-            for (const GraphEdge& edge : current.get_edges()) {
-                int neighbor_id = edge.get_to_id();
-                if (!visited.contains(neighbor_id)) {
-                    parent[neighbor_id] = current_id;
-                    stack.push_back(&graph.get_node_by_id(edge.get_to_id()));
-                } else if (neighbor_id != parent[current_id]) {
+            visited[index_map.get_index(current_id)] = true;
+            for (const GraphNeighbor neighbor : graph.get_neighbors(current_id)) {
+                const int neighbor_id = neighbor.id;
+                const size_t neighbor_index = index_map.get_index(neighbor_id);
+                if (!visited[neighbor_index]) {
+                    parent[neighbor_index] = current_id;
+                    stack.push_back(neighbor_id);
+                } else if (neighbor_id != parent_of(current_id)) {
                     std::vector<int> cycle;
                     int x = current_id;
                     int y = neighbor_id;
-                    std::unordered_set<int> path_x;
+                    std::vector<bool> in_path_x(graph.size(), false);
                     while (true) {
-                        path_x.insert(x);
-                        if (!parent.contains(x))
+                        in_path_x[index_map.get_index(x)] = true;
+                        if (!has_parent(x))
                             break;
-                        x = parent[x];
+                        x = parent_of(x);
                     }
                     std::vector<int> path_to_lca;
-                    while (!path_x.contains(y)) {
+                    while (!in_path_x[index_map.get_index(y)]) {
                         path_to_lca.push_back(y);
-                        if (!parent.contains(y))
+                        if (!has_parent(y))
                             break;
-                        y = parent[y];
+                        y = parent_of(y);
                     }
                     cycle.push_back(y);
                     x = current_id;
                     while (x != y) {
                         cycle.push_back(x);
-                        x = parent[x];
+                        x = parent_of(x);
                     }
                     std::ranges::reverse(path_to_lca);
                     cycle.insert(cycle.end(), path_to_lca.begin(), path_to_lca.end());
@@ -0,0 +1,269 @@
+#include "core/graph/network_simplex.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+constexpr size_t NO_CONSTRAINT = std::numeric_limits<size_t>::max();
+// exchanges allowed per node, against cycling (see compute_optimal_ranks), the ranks stay feasible
+// (just not optimal) if they run out
+constexpr size_t MAX_EXCHANGES_PER_NODE = 64;
+
+class NetworkSimplex {
+    const std::vector<RankConstraint>& m_constraints;
+    std::vector<std::vector<size_t>> m_constraints_of_node;
+    std::vector<std::vector<size_t>> m_tree_constraints_of_node;
+    std::vector<bool> m_in_tree;
+    std::vector<int> m_rank;
+    // weight of the constraints leaving the node minus the weight of the ones entering it
+    std::vector<long long> m_balance;
+    // the tree is rooted at node 0, the subtree of a node is a range of the preorder
+    std::vector<size_t> m_parent_constraint;
+    std::vector<size_t> m_preorder;
+    std::vector<size_t> m_preorder_position;
+    std::vector<size_t> m_subtree_size;
+    std::vector<long long> m_subtree_balance;
+    size_t m_search_start = 0;
+    [[nodiscard]] int get_slack(size_t constraint) const;
+    [[nodiscard]] size_t get_other_endpoint(size_t constraint, size_t node) const;
+    [[nodiscard]] bool is_in_subtree(size_t node, size_t subtree_root) const;
+    [[nodiscard]] long long get_cut_value(size_t constraint) const;
+    void add_to_tree(size_t constraint);
+    void remove_from_tree(size_t constraint);
+    void compute_initial_ranks();
+    void compute_feasible_tree();
+    void compute_tree_structure();
+    size_t find_leaving_constraint();
+    [[nodiscard]] size_t find_entering_constraint(size_t leaving) const;
+    void exchange(size_t leaving, size_t entering);
+
+  public:
+    NetworkSimplex(size_t number_of_nodes, const std::vector<RankConstraint>& constraints);
+    std::vector<int> solve();
+};
+
+NetworkSimplex::NetworkSimplex(const size_t number_of_nodes,
+                               const std::vector<RankConstraint>& constraints)
+    : m_constraints(constraints), m_constraints_of_node(number_of_nodes),
+      m_tree_constraints_of_node(number_of_nodes), m_in_tree(constraints.size(), false),
+      m_rank(number_of_nodes, 0), m_balance(number_of_nodes, 0),
+      m_parent_constraint(number_of_nodes, NO_CONSTRAINT),
+      m_preorder_position(number_of_nodes, 0), m_subtree_size(number_of_nodes, 0),
+      m_subtree_balance(number_of_nodes, 0) {
+    for (size_t constraint = 0; constraint < constraints.size(); ++constraint) {
+        const auto& [from, to, min_length, weight] = constraints[constraint];
+        if (from >= number_of_nodes || to >= number_of_nodes)
+            throw std::runtime_error("compute_optimal_ranks: constraint on a missing node");
+        if (min_length < 0 || weight < 0)
+            throw std::runtime_error("compute_optimal_ranks: negative constraint");
+        m_constraints_of_node[from].push_back(constraint);
+        m_constraints_of_node[to].push_back(constraint);
+        m_balance[from] += weight;
+        m_balance[to] -= weight;
+    }
+}
+
+int NetworkSimplex::get_slack(const size_t constraint) const {
+    const RankConstraint& c = m_constraints[constraint];
+    return m_rank[c.to] - m_rank[c.from] - c.min_length;
+}
+
+size_t NetworkSimplex::get_other_endpoint(const size_t constraint, const size_t node) const {
+    const RankConstraint& c = m_constraints[constraint];
+    return c.from == node ? c.to : c.from;
+}
+
+bool NetworkSimplex::is_in_subtree(const size_t node, const size_t subtree_root) const {
+    const size_t first = m_preorder_position[subtree_root];
+    const size_t position = m_preorder_position[node];
+    return first <= position && position < first + m_subtree_size[subtree_root];
+}
+
+// weight of the constraints from the tail component (the one of from, once the constraint is
+// removed from the tree) to the head one, minus the weight of the ones going back
+long long NetworkSimplex::get_cut_value(const size_t constraint) const {
+    const RankConstraint& c = m_constraints[constraint];
+    if (m_parent_constraint[c.from] == constraint)
+        return m_subtree_balance[c.from];
+    return -m_subtree_balance[c.to];
+}
+
+void NetworkSimplex::add_to_tree(const size_t constraint) {
+    m_in_tree[constraint] = true;
+    m_tree_constraints_of_node[m_constraints[constraint].from].push_back(constraint);
+    m_tree_constraints_of_node[m_constraints[constraint].to].push_back(constraint);
+}
+
+void NetworkSimplex::remove_from_tree(const size_t constraint) {
+    m_in_tree[constraint] = false;
+    std::erase(m_tree_constraints_of_node[m_constraints[constraint].from], constraint);
+    std::erase(m_tree_constraints_of_node[m_constraints[constraint].to], constraint);
+}
+
+// longest paths from the sources, in topological order
+void NetworkSimplex::compute_initial_ranks() {
+    std::vector<size_t> in_degree(m_rank.size(), 0);
+    for (const RankConstraint& constraint : m_constraints)
+        ++in_degree[constraint.to];
+    std::vector<size_t> ready;
+    for (size_t node = 0; node < m_rank.size(); ++node)
+        if (in_degree[node] == 0)
+            ready.push_back(node);
+    size_t number_of_ranked_nodes = 0;
+    while (!ready.empty()) {
+        const size_t node = ready.back();
+        ready.pop_back();
+        ++number_of_ranked_nodes;
+        for (const size_t constraint : m_constraints_of_node[node]) {
+            const RankConstraint& c = m_constraints[constraint];
+            if (c.from != node)
+                continue;
+            m_rank[c.to] = std::max(m_rank[c.to], m_rank[node] + c.min_length);
+            if (--in_degree[c.to] == 0)
+                ready.push_back(c.to);
+        }
+    }
+    if (number_of_ranked_nodes != m_rank.size())
+        throw std::runtime_error("compute_optimal_ranks: constraints contain a cycle");
+}
+
+// the tight tree grows from node 0, when it gets stuck it moves as a whole to make tight the
+// constraint with the least slack leaving it
+void NetworkSimplex::compute_feasible_tree() {
+    std::vector<bool> node_in_tree(m_rank.size(), false);
+    std::vector<size_t> tree_nodes = {0};
+    node_in_tree[0] = true;
+    std::vector<size_t> to_visit = {0};
+    while (true) {
+        while (!to_visit.empty()) {
+            const size_t node = to_visit.back();
+            to_visit.pop_back();
+            for (const size_t constraint : m_constraints_of_node[node]) {
+                const size_t other = get_other_endpoint(constraint, node);
+                if (node_in_tree[other] || get_slack(constraint) != 0)
+                    continue;
+                add_to_tree(constraint);
+                node_in_tree[other] = true;
+                tree_nodes.push_back(other);
+                to_visit.push_back(other);
+            }
+        }
+        if (tree_nodes.size() == m_rank.size())
+            return;
+        size_t closest = NO_CONSTRAINT;
+        for (size_t constraint = 0; constraint < m_constraints.size(); ++constraint) {
+            const RankConstraint& c = m_constraints[constraint];
+            if (node_in_tree[c.from] == node_in_tree[c.to])
+                continue;
+            if (closest == NO_CONSTRAINT || get_slack(constraint) < get_slack(closest))
+                closest = constraint;
+        }
+        if (closest == NO_CONSTRAINT)
+            throw std::runtime_error("compute_optimal_ranks: constraints do not connect all nodes");
+        const int slack = get_slack(closest);
+        const int shift = node_in_tree[m_constraints[closest].from] ? slack : -slack;
+        for (const size_t node : tree_nodes)
+            m_rank[node] += shift;
+        to_visit = tree_nodes;
+    }
+}
+
+void NetworkSimplex::compute_tree_structure() {
+    m_preorder.clear();
+    m_parent_constraint[0] = NO_CONSTRAINT;
+    std::vector<size_t> to_visit = {0};
+    while (!to_visit.empty()) {
+        const size_t node = to_visit.back();
+        to_visit.pop_back();
+        m_preorder_position[node] = m_preorder.size();
+        m_preorder.push_back(node);
+        m_subtree_size[node] = 1;
+        m_subtree_balance[node] = m_balance[node];
+        for (const size_t constraint : m_tree_constraints_of_node[node]) {
+            if (constraint == m_parent_constraint[node])
+                continue;
+            const size_t child = get_other_endpoint(constraint, node);
+            m_parent_constraint[child] = constraint;
+            to_visit.push_back(child);
+        }
+    }
+    for (auto it = m_preorder.rbegin(); it != m_preorder.rend(); ++it) {
+        const size_t constraint = m_parent_constraint[*it];
+        if (constraint == NO_CONSTRAINT)
+            continue;
+        const size_t parent = get_other_endpoint(constraint, *it);
+        m_subtree_size[parent] += m_subtree_size[*it];
+        m_subtree_balance[parent] += m_subtree_balance[*it];
+    }
+}
+
+// the search goes on from where the previous one stopped
+size_t NetworkSimplex::find_leaving_constraint() {
+    const size_t number_of_constraints = m_constraints.size();
+    for (size_t i = 0; i < number_of_constraints; ++i) {
+        const size_t constraint = (m_search_start + i) % number_of_constraints;
+        if (m_in_tree[constraint] && get_cut_value(constraint) < 0) {
+            m_search_start = (constraint + 1) % number_of_constraints;
+            return constraint;
+        }
+    }
+    return NO_CONSTRAINT;
+}
+
+// the constraint with the least slack from the head component of the leaving one to its tail
+// component, there is one since the cut value of the leaving one is negative
+size_t NetworkSimplex::find_entering_constraint(const size_t leaving) const {
+    const RankConstraint& l = m_constraints[leaving];
+    const bool tail_is_subtree = m_parent_constraint[l.from] == leaving;
+    const size_t subtree_root = tail_is_subtree ? l.from : l.to;
+    size_t entering = NO_CONSTRAINT;
+    for (size_t constraint = 0; constraint < m_constraints.size(); ++constraint) {
+        if (m_in_tree[constraint])
+            continue;
+        const bool from_in_subtree = is_in_subtree(m_constraints[constraint].from, subtree_root);
+        const bool to_in_subtree = is_in_subtree(m_constraints[constraint].to, subtree_root);
+        if (from_in_subtree == to_in_subtree || to_in_subtree != tail_is_subtree)
+            continue;
+        if (entering == NO_CONSTRAINT || get_slack(constraint) < get_slack(entering))
+            entering = constraint;
+    }
+    return entering;
+}
+
+// the subtree cut off by the leaving constraint moves to make the entering one tight
+void NetworkSimplex::exchange(const size_t leaving, const size_t entering) {
+    const RankConstraint& l = m_constraints[leaving];
+    const bool tail_is_subtree = m_parent_constraint[l.from] == leaving;
+    const size_t subtree_root = tail_is_subtree ? l.from : l.to;
+    const int slack = get_slack(entering);
+    const int shift = tail_is_subtree ? -slack : slack;
+    const size_t first = m_preorder_position[subtree_root];
+    for (size_t position = first; position < first + m_subtree_size[subtree_root]; ++position)
+        m_rank[m_preorder[position]] += shift;
+    remove_from_tree(leaving);
+    add_to_tree(entering);
+}
+
+std::vector<int> NetworkSimplex::solve() {
+    if (m_rank.empty())
+        return {};
+    compute_initial_ranks();
+    compute_feasible_tree();
+    compute_tree_structure();
+    for (size_t i = 0; i < MAX_EXCHANGES_PER_NODE * m_rank.size(); ++i) {
+        const size_t leaving = find_leaving_constraint();
+        if (leaving == NO_CONSTRAINT)
+            break;
+        exchange(leaving, find_entering_constraint(leaving));
+        compute_tree_structure();
+    }
+    const int min_rank = std::ranges::min(m_rank);
+    for (int& rank : m_rank)
+        rank -= min_rank;
+    return m_rank;
+}
+
+std::vector<int> compute_optimal_ranks(const size_t number_of_nodes,
+                                       const std::vector<RankConstraint>& constraints) {
+    return NetworkSimplex(number_of_nodes, constraints).solve();
+}
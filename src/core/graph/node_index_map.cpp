@@ -0,0 +1,73 @@
+#include "core/graph/node_index_map.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// ids below this bound (or below twice the number of nodes, reserved ones included) are stored in
+// the dense table
+constexpr size_t MIN_DENSE_IDS = 1024;
+
+void NodeIndexMap::set_index(const int node_id, const size_t index) {
+    const auto it = m_sparse_node_id_to_index.find(node_id);
+    if (it != m_sparse_node_id_to_index.end()) {
+        it->second = index;
+        return;
+    }
+    const auto id = static_cast<size_t>(node_id);
+    if (id < m_dense_node_id_to_index.size()) {
+        m_dense_node_id_to_index[id] = index;
+        return;
+    }
+    if (id < std::max(MIN_DENSE_IDS, 2 * std::max(size(), m_index_to_node_id.capacity()))) {
+        m_dense_node_id_to_index.resize(std::max(id + 1, 2 * m_dense_node_id_to_index.size()),
+                                        NO_INDEX);
+        m_dense_node_id_to_index[id] = index;
+        return;
+    }
+    m_sparse_node_id_to_index[node_id] = index;
+}
+
+void NodeIndexMap::add_node(const int node_id) {
+    if (node_id < 0)
+        throw std::runtime_error("NodeIndexMap::add_node: id must be non-negative");
+    if (has_node(node_id))
+        throw std::runtime_error("NodeIndexMap::add_node: node already present");
+    set_index(node_id, m_index_to_node_id.size());
+    m_index_to_node_id.push_back(node_id);
+}
+
+void NodeIndexMap::remove_node(const int node_id) {
+    const size_t index = get_index(node_id);
+    const int last_node_id = m_index_to_node_id.back();
+    m_index_to_node_id[index] = last_node_id;
+    set_index(last_node_id, index);
+    m_index_to_node_id.pop_back();
+    const auto id = static_cast<size_t>(node_id);
+    if (id < m_dense_node_id_to_index.size() && m_dense_node_id_to_index[id] != NO_INDEX)
+        m_dense_node_id_to_index[id] = NO_INDEX;
+    else
+        m_sparse_node_id_to_index.erase(node_id);
+}
+
+void NodeIndexMap::reserve(const size_t number_of_nodes) {
+    m_index_to_node_id.reserve(number_of_nodes);
+}
+
+bool NodeIndexMap::has_node(const int node_id) const { return find_index(node_id) != NO_INDEX; }
+
+size_t NodeIndexMap::get_index(const int node_id) const {
+    const size_t index = find_index(node_id);
+    if (index == NO_INDEX)
+        throw std::runtime_error("NodeIndexMap::get_index: node not found");
+    return index;
+}
+
+size_t NodeIndexMap::find_index(const int node_id) const {
+    if (node_id < 0)
+        return NO_INDEX;
+    const auto id = static_cast<size_t>(node_id);
+    if (id < m_dense_node_id_to_index.size() && m_dense_node_id_to_index[id] != NO_INDEX)
+        return m_dense_node_id_to_index[id];
+    const auto it = m_sparse_node_id_to_index.find(node_id);
+    return it != m_sparse_node_id_to_index.end() ? it->second : NO_INDEX;
+}
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "core/graph/graph_builder.hpp"
+
 Segment::Segment() {
     this->segment = std::make_unique<UndirectedSimpleGraph>();
     this->attachments = {};
@@ -106,10 +108,10 @@ void dfs_find_segments(const UndirectedSimpleGraph& graph,
     }
 }
 
-void add_cycle_edges(const Cycle& cycle, Segment& segment) {
+void add_cycle_edges(const Cycle& cycle, GraphBuilder& builder) {
     for (const int node_id : cycle) {
         const int next_node_id = cycle.next_of_node(node_id);
-        segment.get_segment().add_edge(node_id, next_node_id);
+        builder.add_edge(node_id, next_node_id);
     }
 }
 
@@ -117,13 +119,13 @@ Segment build_segment(const std::vector<int>& nodes,
                       std::vector<std::pair<int, int>>& edges,
                       const Cycle& cycle) {
     Segment segment;
+    GraphBuilder builder(cycle.size() + nodes.size(), cycle.size() + edges.size());
     for (const int node_id : cycle)
-        segment.get_segment().add_node(node_id);
-    for (const int node_id : nodes)
-        segment.get_segment().add_node(node_id);
+        builder.add_node(node_id);
+    builder.add_nodes(nodes);
     // adding edges
+    builder.add_edges(edges);
     for (const auto& [from_id, to_id] : edges) {
-        segment.get_segment().add_edge(from_id, to_id);
         // adding attachment
         if (cycle.has_node(from_id))
             segment.add_attachment(from_id);
@@ -131,7 +133,8 @@ Segment build_segment(const std::vector<int>& nodes,
             segment.add_attachment(to_id);
     }
     // adding cycle edges
-    add_cycle_edges(cycle, segment);
+    add_cycle_edges(cycle, builder);
+    builder.finish(segment.get_segment());
     return segment;
 }
 
@@ -154,11 +157,13 @@ void find_segments(const UndirectedSimpleGraph& graph,
 
 Segment build_chord(const int attachment_1, const int attachment_2, const Cycle& cycle) {
     Segment chord;
+    GraphBuilder builder(cycle.size(), cycle.size() + 1);
     for (const int node_id : cycle)
-        chord.get_segment().add_node(node_id);
-    add_cycle_edges(cycle, chord);
+        builder.add_node(node_id);
+    add_cycle_edges(cycle, builder);
     // adding chord edge
-    chord.get_segment().add_edge(attachment_1, attachment_2);
+    builder.add_edge(attachment_1, attachment_2);
+    builder.finish(chord.get_segment());
     chord.add_attachment(attachment_1);
     chord.add_attachment(attachment_2);
     return chord;
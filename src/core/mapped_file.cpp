@@ -0,0 +1,35 @@
+#include "core/mapped_file.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// an empty file is not mapped (mmap does not accept a length of 0)
+MappedFile::MappedFile(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Could not open file: " + filename);
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not read the size of file: " + filename);
+    }
+    m_size = static_cast<size_t>(file_stat.st_size);
+    if (m_size != 0) {
+        m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m_data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map file: " + filename);
+        }
+    }
+    // the mapping outlives the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+}
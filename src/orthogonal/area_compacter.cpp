@@ -1,113 +1,406 @@
 #include "orthogonal/area_compacter.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "core/graph/network_simplex.hpp"
 #include "orthogonal/drawing_builder.hpp"
 
-auto build_index_to_nodes_map(const UndirectedSimpleGraph& graph,
-                              const GraphAttributes& attributes) {
-    auto [node_to_index_x, node_to_index_y] = compute_node_to_index_position(graph, attributes);
-    std::unordered_map<int, std::unordered_set<int>> index_x_to_nodes;
-    for (const auto& [node_id, index] : node_to_index_x)
-        index_x_to_nodes[index].insert(node_id);
-    std::unordered_map<int, std::unordered_set<int>> index_y_to_nodes;
-    for (const auto& [node_id, index] : node_to_index_y)
-        index_y_to_nodes[index].insert(node_id);
-    return std::make_tuple(index_x_to_nodes, node_to_index_x, index_y_to_nodes, node_to_index_y);
-}
-
-bool can_move_to_prev_index(IntPairHashSet& prev, IntPairHashSet& to_shift) {
-    if (to_shift.size() != 1)
-        throw std::runtime_error("can_move_left: wtf");
-    auto [to_shift_min, to_shift_max] = *to_shift.begin();
-    for (auto [prev_min, prev_max] : prev)
-        if (!(prev_min > to_shift_max || to_shift_min > prev_max))
+// values assigned to ranges of [0, size), values only grow, the maximum over a range is read in
+// O(log size); -1 where nothing was assigned
+class RangeMaxTree {
+    size_t m_size;
+    // maximum of the values assigned to some range intersecting the one of the node
+    std::vector<int> m_max;
+    // maximum of the values assigned to ranges containing the one of the node
+    std::vector<int> m_assigned;
+    void assign(size_t node, size_t node_min, size_t node_max, size_t min, size_t max, int value);
+    [[nodiscard]] int
+    get_max(size_t node, size_t node_min, size_t node_max, size_t min, size_t max) const;
+
+  public:
+    explicit RangeMaxTree(const size_t size)
+        : m_size(size), m_max(4 * size, -1), m_assigned(4 * size, -1) {}
+    // every position in [min, max] gets at least value
+    void assign(const size_t min, const size_t max, const int value) {
+        assign(1, 0, m_size - 1, min, max, value);
+    }
+    [[nodiscard]] int get_max(const size_t min, const size_t max) const {
+        return get_max(1, 0, m_size - 1, min, max);
+    }
+};
+
+void RangeMaxTree::assign(const size_t node,
+                          const size_t node_min,
+                          const size_t node_max,
+                          const size_t min,
+                          const size_t max,
+                          const int value) {
+    if (max < node_min || node_max < min)
+        return;
+    m_max[node] = std::max(m_max[node], value);
+    if (min <= node_min && node_max <= max) {
+        m_assigned[node] = std::max(m_assigned[node], value);
+        return;
+    }
+    const size_t middle = (node_min + node_max) / 2;
+    assign(2 * node, node_min, middle, min, max, value);
+    assign(2 * node + 1, middle + 1, node_max, min, max, value);
+}
+
+int RangeMaxTree::get_max(const size_t node,
+                          const size_t node_min,
+                          const size_t node_max,
+                          const size_t min,
+                          const size_t max) const {
+    if (max < node_min || node_max < min)
+        return -1;
+    if (min <= node_min && node_max <= max)
+        return m_max[node];
+    const size_t middle = (node_min + node_max) / 2;
+    return std::max({m_assigned[node],
+                     get_max(2 * node, node_min, middle, min, max),
+                     get_max(2 * node + 1, middle + 1, node_max, min, max)});
+}
+
+constexpr int MIXED_VALUES = -2;
+
+// the last value assigned to every position of [0, size), -1 where nothing was assigned; the
+// distinct values of a range are collected in O((number of them + 1) log size)
+class RangeAssignTree {
+    size_t m_size;
+    // value of all the positions of the node, MIXED_VALUES when they differ
+    std::vector<int> m_value;
+    void assign(size_t node, size_t node_min, size_t node_max, size_t min, size_t max, int value);
+    void collect(size_t node,
+                 size_t node_min,
+                 size_t node_max,
+                 size_t min,
+                 size_t max,
+                 std::vector<int>& values) const;
+
+  public:
+    explicit RangeAssignTree(const size_t size) : m_size(size), m_value(4 * size, -1) {}
+    void assign(const size_t min, const size_t max, const int value) {
+        assign(1, 0, m_size - 1, min, max, value);
+    }
+    // the values in [min, max] are added to values, a value can be added more than once
+    void collect(const size_t min, const size_t max, std::vector<int>& values) const {
+        collect(1, 0, m_size - 1, min, max, values);
+    }
+};
+
+void RangeAssignTree::assign(const size_t node,
+                             const size_t node_min,
+                             const size_t node_max,
+                             const size_t min,
+                             const size_t max,
+                             const int value) {
+    if (max < node_min || node_max < min)
+        return;
+    if (min <= node_min && node_max <= max) {
+        m_value[node] = value;
+        return;
+    }
+    if (m_value[node] != MIXED_VALUES) {
+        m_value[2 * node] = m_value[node];
+        m_value[2 * node + 1] = m_value[node];
+    }
+    const size_t middle = (node_min + node_max) / 2;
+    assign(2 * node, node_min, middle, min, max, value);
+    assign(2 * node + 1, middle + 1, node_max, min, max, value);
+    m_value[node] =
+        m_value[2 * node] == m_value[2 * node + 1] ? m_value[2 * node] : MIXED_VALUES;
+}
+
+void RangeAssignTree::collect(const size_t node,
+                              const size_t node_min,
+                              const size_t node_max,
+                              const size_t min,
+                              const size_t max,
+                              std::vector<int>& values) const {
+    if (max < node_min || node_max < min)
+        return;
+    if (m_value[node] != MIXED_VALUES) {
+        if (m_value[node] != -1)
+            values.push_back(m_value[node]);
+        return;
+    }
+    const size_t middle = (node_min + node_max) / 2;
+    collect(2 * node, node_min, middle, min, max, values);
+    collect(2 * node + 1, middle + 1, node_max, min, max, values);
+}
+
+size_t get_number_of_indices(const std::vector<int>& index) {
+    int max_index = 0;
+    for (const int node_index : index)
+        max_index = std::max(max_index, node_index);
+    return static_cast<size_t>(max_index) + 1;
+}
+
+// for each index of an axis, the smallest and largest index in the other axis of its nodes
+std::vector<std::pair<int, int>> compute_index_intervals(const std::vector<int>& index,
+                                                         const std::vector<int>& other_index) {
+    std::vector<std::pair<int, int>> intervals(get_number_of_indices(index), {INT_MAX, 0});
+    for (size_t node = 0; node < index.size(); ++node) {
+        auto& [min, max] = intervals[static_cast<size_t>(index[node])];
+        const int other = other_index[node];
+        min = std::min(min, other);
+        max = std::max(max, other);
+    }
+    return intervals;
+}
+
+// how far each index moves towards 0: right after the closest previous index that (together with
+// the indices already moved into it) has an interval overlapping its own, or to 0 if none has
+std::vector<int> compute_index_shifts(const std::vector<std::pair<int, int>>& intervals,
+                                      const size_t number_of_other_indices) {
+    RangeMaxTree targets(number_of_other_indices);
+    std::vector<int> shifts(intervals.size(), 0);
+    for (size_t index = 0; index < intervals.size(); ++index) {
+        const auto min = static_cast<size_t>(intervals[index].first);
+        const auto max = static_cast<size_t>(intervals[index].second);
+        const int target = targets.get_max(min, max) + 1;
+        shifts[index] = static_cast<int>(index) - target;
+        targets.assign(min, max, target);
+    }
+    return shifts;
+}
+
+void compact_area_shifting_indices(const UndirectedSimpleGraph& graph,
+                                   GraphAttributes& attributes) {
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    const IndexPositions index_positions = compute_index_positions(nodes_ids, attributes);
+    const std::vector<int>& index_x = index_positions.index_x;
+    const std::vector<int>& index_y = index_positions.index_y;
+    // both axes start from the indices before compacting
+    const std::vector<int> shifts_x = compute_index_shifts(
+        compute_index_intervals(index_x, index_y), get_number_of_indices(index_y));
+    const std::vector<int> shifts_y = compute_index_shifts(
+        compute_index_intervals(index_y, index_x), get_number_of_indices(index_x));
+    for (size_t node = 0; node < nodes_ids.size(); ++node) {
+        const int node_id = nodes_ids[node];
+        const int shift_x = shifts_x[static_cast<size_t>(index_x[node])];
+        const int shift_y = shifts_y[static_cast<size_t>(index_y[node])];
+        if (shift_x != 0)
+            attributes.change_position_x(node_id,
+                                         attributes.get_position_x(node_id) - 100 * shift_x);
+        if (shift_y != 0)
+            attributes.change_position_y(node_id,
+                                         attributes.get_position_y(node_id) - 100 * shift_y);
+    }
+}
+
+// every coordinate is a multiple of 100 and every edge is horizontal or vertical
+bool is_drawing_on_grid(const UndirectedSimpleGraph& graph, const GraphAttributes& attributes) {
+    for (const int node_id : graph.get_nodes_ids())
+        if (attributes.get_position_x(node_id) % 100 != 0 ||
+            attributes.get_position_y(node_id) % 100 != 0)
+            return false;
+    for (const GraphEdge& edge : graph.get_edges())
+        if (attributes.get_position_x(edge.get_from_id()) !=
+                attributes.get_position_x(edge.get_to_id()) &&
+            attributes.get_position_y(edge.get_from_id()) !=
+                attributes.get_position_y(edge.get_to_id()))
             return false;
     return true;
 }
 
-int compute_shift_amount(const int index,
-                         std::unordered_map<int, IntPairHashSet>& index_to_min_max_coordinate) {
-    int shift = 0;
-    IntPairHashSet& to_shift = index_to_min_max_coordinate[index];
-    while (true) {
-        if (index - shift == 0)
-            return shift;
-        IntPairHashSet& prev = index_to_min_max_coordinate[index - shift - 1];
-        if (can_move_to_prev_index(prev, to_shift))
-            shift++;
-        else
-            break;
-    }
-    return shift;
-}
-
-auto build_index_x_to_min_max_index_y(
-    std::unordered_map<int, std::unordered_set<int>>& index_x_to_nodes,
-    std::unordered_map<int, int>& node_to_index_y) {
-    std::unordered_map<int, IntPairHashSet> index_to_min_max_y;
-    for (const auto& [index, nodes] : index_x_to_nodes) {
-        int min_y = INT_MAX;
-        int max_y = 0;
-        for (int node_id : nodes) {
-            int y = node_to_index_y[node_id];
-            min_y = std::min(min_y, y);
-            max_y = std::max(max_y, y);
-        }
-        index_to_min_max_y[index] = {{min_y, max_y}};
-    }
-    return index_to_min_max_y;
-}
-
-auto build_index_y_to_min_max_index_x(
-    std::unordered_map<int, std::unordered_set<int>>& index_to_nodes,
-    std::unordered_map<int, int>& node_to_index_x) {
-    std::unordered_map<int, IntPairHashSet> index_to_min_max_x;
-    for (const auto& [index, nodes] : index_to_nodes) {
-        int min_x = INT_MAX;
-        int max_x = 0;
-        for (int node_id : nodes) {
-            int x = node_to_index_x[node_id];
-            min_x = std::min(min_x, x);
-            max_x = std::max(max_x, x);
+size_t find_root(std::vector<size_t>& parent, size_t element) {
+    while (parent[element] != element) {
+        parent[element] = parent[parent[element]];
+        element = parent[element];
+    }
+    return element;
+}
+
+// the nodes joined by edges across an axis (same index) form classes, each spanning an interval
+// of the other axis
+struct IndexClasses {
+    // class of every node (by its dense index), the classes are numbered by increasing index
+    std::vector<size_t> node_class;
+    std::vector<int> index;
+    std::vector<std::pair<int, int>> intervals;
+};
+
+IndexClasses compute_index_classes(const UndirectedSimpleGraph& graph,
+                                   const NodeIndexMap& node_index,
+                                   const std::vector<int>& index,
+                                   const std::vector<int>& other_index) {
+    std::vector<size_t> parent(index.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (const GraphEdge& edge : graph.get_edges()) {
+        const size_t from = node_index.get_index(edge.get_from_id());
+        const size_t to = node_index.get_index(edge.get_to_id());
+        if (index[from] == index[to])
+            parent[find_root(parent, from)] = find_root(parent, to);
+    }
+    std::vector<size_t> roots;
+    std::vector<bool> is_root(index.size(), false);
+    for (size_t node = 0; node < index.size(); ++node) {
+        const size_t root = find_root(parent, node);
+        if (!is_root[root])
+            roots.push_back(root);
+        is_root[root] = true;
+    }
+    std::ranges::sort(roots, {}, [&index](const size_t root) { return index[root]; });
+    IndexClasses classes{std::vector<size_t>(index.size(), 0),
+                         std::vector<int>(roots.size(), 0),
+                         std::vector<std::pair<int, int>>(roots.size(), {INT_MAX, 0})};
+    std::vector<size_t> root_class(index.size(), 0);
+    for (size_t i = 0; i < roots.size(); ++i) {
+        root_class[roots[i]] = i;
+        classes.index[i] = index[roots[i]];
+    }
+    for (size_t node = 0; node < index.size(); ++node) {
+        const size_t node_class = root_class[find_root(parent, node)];
+        classes.node_class[node] = node_class;
+        auto& [min, max] = classes.intervals[node_class];
+        min = std::min(min, other_index[node]);
+        max = std::max(max, other_index[node]);
+    }
+    return classes;
+}
+
+// end of the group of classes with the index of the first one, they do not constrain each other
+size_t get_end_of_index(const IndexClasses& classes, const size_t first) {
+    size_t last = first;
+    while (last < classes.index.size() && classes.index[last] == classes.index[first])
+        ++last;
+    return last;
+}
+
+// new index of every node on one axis: a class must come after every class with a smaller index
+// and an overlapping interval, so each class gets the longest path reaching it in that constraint
+// graph, read from a RangeMaxTree while sweeping the classes by index
+std::vector<int> compute_longest_path_indices(const UndirectedSimpleGraph& graph,
+                                              const NodeIndexMap& node_index,
+                                              const std::vector<int>& index,
+                                              const std::vector<int>& other_index) {
+    const IndexClasses classes = compute_index_classes(graph, node_index, index, other_index);
+    RangeMaxTree previous_classes(get_number_of_indices(other_index));
+    std::vector<int> class_index(classes.index.size(), 0);
+    for (size_t first = 0; first < classes.index.size();) {
+        const size_t last = get_end_of_index(classes, first);
+        for (size_t i = first; i < last; ++i) {
+            const auto [min, max] = classes.intervals[i];
+            class_index[i] =
+                previous_classes.get_max(static_cast<size_t>(min), static_cast<size_t>(max)) + 1;
         }
-        index_to_min_max_x[index] = {{min_x, max_x}};
-    }
-    return index_to_min_max_x;
-}
-
-void compact_area(const UndirectedSimpleGraph& graph, GraphAttributes& attributes) {
-    auto [index_x_to_nodes, nodes_to_index_x, index_y_to_nodes, nodes_to_index_y] =
-        build_index_to_nodes_map(graph, attributes);
-    // compacting x
-    auto index_to_min_max_y = build_index_x_to_min_max_index_y(index_x_to_nodes, nodes_to_index_y);
-    int index = 0;
-    while (index_to_min_max_y.contains(index + 1)) {
-        ++index;
-        int shift_amount = compute_shift_amount(index, index_to_min_max_y);
-        if (shift_amount == 0) {
-            continue;
+        for (size_t i = first; i < last; ++i) {
+            const auto [min, max] = classes.intervals[i];
+            previous_classes.assign(
+                static_cast<size_t>(min), static_cast<size_t>(max), class_index[i]);
         }
-        std::unordered_set<int>& nodes_to_shift = index_x_to_nodes[index];
-        for (int node_id : nodes_to_shift) {
-            int old_x = attributes.get_position_x(node_id);
-            attributes.change_position_x(node_id, old_x - 100 * shift_amount);
+        first = last;
+    }
+    std::vector<int> new_index(index.size(), -1);
+    for (size_t node = 0; node < index.size(); ++node)
+        new_index[node] = class_index[classes.node_class[node]];
+    return new_index;
+}
+
+// weight of the width (height) of the drawing against the total length of the edges along the axis
+constexpr int EXTENT_WEIGHT = 1;
+
+// new index of every node on one axis: the classes get the ranks with the smallest total length of
+// the edges along the axis plus the extent of the drawing on it, from a network simplex; a class
+// stays at least 1 after each class with a smaller index it sees (overlapping interval, no class in
+// between, read from a RangeAssignTree while sweeping the classes by index), which keeps it after
+// all the classes it overlaps
+std::vector<int> compute_min_length_indices(const UndirectedSimpleGraph& graph,
+                                            const NodeIndexMap& node_index,
+                                            const std::vector<int>& index,
+                                            const std::vector<int>& other_index) {
+    const IndexClasses classes = compute_index_classes(graph, node_index, index, other_index);
+    const size_t number_of_classes = classes.index.size();
+    // ranks before and after all the classes, their distance is the extent of the drawing
+    const size_t first_rank = number_of_classes;
+    const size_t last_rank = number_of_classes + 1;
+    std::vector<RankConstraint> constraints;
+    constraints.push_back({first_rank, last_rank, 0, EXTENT_WEIGHT});
+    for (size_t i = 0; i < number_of_classes; ++i) {
+        constraints.push_back({first_rank, i, 0, 0});
+        constraints.push_back({i, last_rank, 0, 0});
+    }
+    RangeAssignTree last_classes(get_number_of_indices(other_index));
+    std::vector<int> seen_classes;
+    for (size_t first = 0; first < number_of_classes;) {
+        const size_t last = get_end_of_index(classes, first);
+        for (size_t i = first; i < last; ++i) {
+            const auto [min, max] = classes.intervals[i];
+            seen_classes.clear();
+            last_classes.collect(static_cast<size_t>(min), static_cast<size_t>(max), seen_classes);
+            std::ranges::sort(seen_classes);
+            const auto repeated = std::ranges::unique(seen_classes);
+            seen_classes.erase(repeated.begin(), repeated.end());
+            for (const int seen_class : seen_classes)
+                constraints.push_back({static_cast<size_t>(seen_class), i, 1, 0});
         }
-        index_to_min_max_y[index - shift_amount].insert(*index_to_min_max_y[index].begin());
-        index_to_min_max_y[index].clear();
-    }
-    // compacting y
-    auto index_to_min_max_x = build_index_y_to_min_max_index_x(index_y_to_nodes, nodes_to_index_x);
-    index = 0;
-    while (index_to_min_max_x.contains(index + 1)) {
-        ++index;
-        int shift_amount = compute_shift_amount(index, index_to_min_max_x);
-        if (shift_amount == 0)
-            continue;
-        std::unordered_set<int>& nodes_to_shift = index_y_to_nodes[index];
-        for (int node_id : nodes_to_shift) {
-            int old_y = attributes.get_position_y(node_id);
-            attributes.change_position_y(node_id, old_y - 100 * shift_amount);
+        for (size_t i = first; i < last; ++i) {
+            const auto [min, max] = classes.intervals[i];
+            last_classes.assign(
+                static_cast<size_t>(min), static_cast<size_t>(max), static_cast<int>(i));
         }
-        index_to_min_max_x[index - shift_amount].insert(*index_to_min_max_x[index].begin());
-        index_to_min_max_x[index].clear();
+        first = last;
     }
-}
\ No newline at end of file
+    for (const GraphEdge& edge : graph.get_edges()) {
+        const size_t from_class = classes.node_class[node_index.get_index(edge.get_from_id())];
+        const size_t to_class = classes.node_class[node_index.get_index(edge.get_to_id())];
+        if (from_class != to_class)
+            constraints.push_back(
+                {std::min(from_class, to_class), std::max(from_class, to_class), 1, 1});
+    }
+    const std::vector<int> ranks = compute_optimal_ranks(number_of_classes + 2, constraints);
+    std::vector<int> new_index(index.size(), -1);
+    for (size_t node = 0; node < index.size(); ++node)
+        new_index[node] = ranks[classes.node_class[node]] - ranks[first_rank];
+    return new_index;
+}
+
+void compact_area_along_constraints(const UndirectedSimpleGraph& graph,
+                                    GraphAttributes& attributes,
+                                    const AreaCompaction compaction) {
+    // nodes are addressed by their position in nodes_ids
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    NodeIndexMap node_index;
+    node_index.reserve(nodes_ids.size());
+    for (const int node_id : nodes_ids)
+        node_index.add_node(node_id);
+    std::vector<int> index_x(nodes_ids.size(), 0);
+    std::vector<int> index_y(nodes_ids.size(), 0);
+    int min_x = INT_MAX;
+    int min_y = INT_MAX;
+    for (const int node_id : nodes_ids) {
+        min_x = std::min(min_x, attributes.get_position_x(node_id));
+        min_y = std::min(min_y, attributes.get_position_y(node_id));
+    }
+    for (size_t node = 0; node < nodes_ids.size(); ++node) {
+        index_x[node] = (attributes.get_position_x(nodes_ids[node]) - min_x) / 100;
+        index_y[node] = (attributes.get_position_y(nodes_ids[node]) - min_y) / 100;
+    }
+    // the y axis is compacted with the x indices already compacted
+    const auto compute_indices = compaction == AreaCompaction::NETWORK_SIMPLEX
+                                     ? compute_min_length_indices
+                                     : compute_longest_path_indices;
+    index_x = compute_indices(graph, node_index, index_x, index_y);
+    index_y = compute_indices(graph, node_index, index_y, index_x);
+    for (size_t node = 0; node < nodes_ids.size(); ++node) {
+        attributes.change_position_x(nodes_ids[node], 100 * index_x[node]);
+        attributes.change_position_y(nodes_ids[node], 100 * index_y[node]);
+    }
+}
+
+void compact_area(const UndirectedSimpleGraph& graph,
+                  GraphAttributes& attributes,
+                  const AreaCompaction compaction) {
+    if (graph.size() == 0)
+        return;
+    if (compaction != AreaCompaction::SHIFT_INDICES && is_drawing_on_grid(graph, attributes))
+        compact_area_along_constraints(graph, attributes, compaction);
+    else
+        compact_area_shifting_indices(graph, attributes);
+}
@@ -2,7 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
-#include <functional>
+#include <limits>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -13,64 +14,24 @@
 #include "orthogonal/equivalence_classes.hpp"
 #include "orthogonal/shape/shape_builder.hpp"
 
-std::vector<int> path_in_class(const UndirectedSimpleGraph& graph,
-                               const int from,
-                               const int to,
-                               const Shape& shape,
-                               const bool go_horizontal) {
-    std::vector<int> path;
-    std::unordered_set<int> visited;
-    std::function<void(int)> dfs = [&](const int current) {
-        if (current == to) {
-            path.push_back(current);
-            return;
-        }
-        visited.insert(current);
-        for (const GraphEdge& edge : graph.get_node_by_id(current).get_edges()) {
-            int neighbor = edge.get_to_id();
-            if (visited.contains(neighbor))
-                continue;
-            if (go_horizontal == shape.is_horizontal(current, neighbor)) {
-                dfs(neighbor);
-                if (!path.empty()) {
-                    path.push_back(current);
-                    return;
-                }
-            }
-        }
-        visited.erase(current);
-    };
-    dfs(from);
-    std::ranges::reverse(path);
-    return path;
-}
-
-Cycle build_cycle_in_graph_from_cycle_in_ordering(
-    const UndirectedSimpleGraph& graph,
-    const Shape& shape,
-    const Cycle& cycle_in_ordering,
-    const DirectedSimpleGraph& ordering,
-    const GraphAttributes& ordering_edge_to_graph_edge,
-    const bool go_horizontal) {
-    std::vector<int> cycle;
-    for (size_t i = 0; i < cycle_in_ordering.size(); ++i) {
-        const int class_id = cycle_in_ordering[i];
+// the edges of the graph behind the edges of the cycle, joined by paths inside the classes
+Cycle build_cycle_in_graph_from_cycle_in_ordering(const Cycle& cycle_in_ordering,
+                                                  const ShapeOrderings& orderings,
+                                                  const Axis axis) {
+    std::vector<std::pair<int, int>> witnesses;
+    witnesses.reserve(cycle_in_ordering.size());
+    for (const int class_id : cycle_in_ordering) {
         const int next_class_id = cycle_in_ordering.next_of_node(class_id);
-        const GraphEdge& edge = ordering.get_edge(class_id, next_class_id);
-        const std::any& edge_label = ordering_edge_to_graph_edge.get_edge_any_label(edge.get_id());
-        const int from = std::any_cast<std::pair<int, int>>(edge_label).first;
-        const int to = std::any_cast<std::pair<int, int>>(edge_label).second;
+        witnesses.push_back(orderings.get_ordering_edge_witness(axis, class_id, next_class_id));
+    }
+    std::vector<int> cycle;
+    for (size_t i = 0; i < witnesses.size(); ++i) {
+        const auto [from, to] = witnesses[i];
         cycle.push_back(from);
-        const int next_next_class_id = cycle_in_ordering.next_of_node(next_class_id);
-        const GraphEdge& next_edge = ordering.get_edge(next_class_id, next_next_class_id);
-        const std::any& next_edge_label =
-            ordering_edge_to_graph_edge.get_edge_any_label(next_edge.get_id());
-        const int next_from = std::any_cast<std::pair<int, int>>(next_edge_label).first;
+        const int next_from = witnesses[(i + 1) % witnesses.size()].first;
         if (to != next_from) {
-            std::vector<int> path = path_in_class(graph, to, next_from, shape, go_horizontal);
-            const auto end = static_cast<size_t>(static_cast<int>(path.size()) - 1);
-            for (size_t j = 0; j < end; ++j)
-                cycle.push_back(path[j]);
+            const std::vector<int> path = orderings.get_path_in_class(axis, to, next_from);
+            cycle.insert(cycle.end(), path.begin(), path.end() - 1);
         }
     }
     return Cycle(cycle);
@@ -81,16 +42,21 @@ void make_svg(const UndirectedSimpleGraph& graph,
               const std::string& filename) {
     int max_x = -INT_MAX;
     int max_y = -INT_MAX;
+    int min_x = INT_MAX;
+    int min_y = INT_MAX;
     const std::vector<const GraphNode*> nodes = graph.get_nodes();
     for (const GraphNode* node : nodes) {
-        max_x = std::max(max_x, attributes.get_position_x(node->get_id()));
-        max_y = std::max(max_y, attributes.get_position_y(node->get_id()));
+        if (!attributes.has_position(node->get_id()))
+            throw std::runtime_error("make_svg: node does not have a position");
     }
-    int min_x = INT_MAX;
-    int min_y = INT_MAX;
+    const std::span<const int> positions_x = attributes.get_positions_x();
+    const std::span<const int> positions_y = attributes.get_positions_y();
     for (const GraphNode* node : nodes) {
-        min_x = std::min(min_x, attributes.get_position_x(node->get_id()));
-        min_y = std::min(min_y, attributes.get_position_y(node->get_id()));
+        const size_t slot = attributes.get_node_slot(node->get_id());
+        max_x = std::max(max_x, positions_x[slot]);
+        max_y = std::max(max_y, positions_y[slot]);
+        min_x = std::min(min_x, positions_x[slot]);
+        min_y = std::min(min_y, positions_y[slot]);
     }
     const double ratio = 1.0 * (max_x - min_x) / (max_y - min_y);
     const int width = static_cast<int>(ratio * 900.0);
@@ -100,15 +66,15 @@ void make_svg(const UndirectedSimpleGraph& graph,
     auto scale_y = ScaleLinear(min_y - 100, max_y + 100, 0, height);
     std::unordered_map<int, Point2D> points;
     for (const GraphNode* node : nodes) {
-        const double x = scale_x.map(attributes.get_position_x(node->get_id()));
-        const double y = scale_y.map(attributes.get_position_y(node->get_id()));
+        const size_t slot = attributes.get_node_slot(node->get_id());
+        const double x = scale_x.map(positions_x[slot]);
+        const double y = scale_y.map(positions_y[slot]);
         points.emplace(node->get_id(), Point2D(x, y));
     }
     for (const GraphNode* node : nodes) {
         const int i = node->get_id();
-        for (const GraphEdge& edge : node->get_edges()) {
-            int j = edge.get_to_id();
-            Line2D line(points.at(i), points.at(j));
+        for (const GraphNeighbor neighbor : node->get_neighbors()) {
+            Line2D line(points.at(i), points.at(neighbor.id));
             drawer.add(line);
         }
     }
@@ -138,6 +104,15 @@ void make_svg(const UndirectedSimpleGraph& graph,
     drawer.save_to_file(filename);
 }
 
+// first two neighbors of a node, in the order they are returned by get_neighbors
+std::pair<int, int> get_two_neighbors(const UndirectedSimpleGraph& graph, const int node_id) {
+    auto neighbors = graph.get_neighbors(node_id);
+    auto it = neighbors.begin();
+    const int first = (*it).id;
+    ++it;
+    return std::make_pair(first, (*it).id);
+}
+
 // useless bends are red nodes with two horizontal or vertical edges
 void remove_useless_bends(UndirectedSimpleGraph& graph,
                           const GraphAttributes& attributes,
@@ -147,18 +122,13 @@ void remove_useless_bends(UndirectedSimpleGraph& graph,
         const int node_id = node->get_id();
         if (attributes.get_node_color(node_id) == Color::BLACK)
             continue;
-        std::vector<GraphEdge> edges = node->get_edges();
-        const int j_1 = edges[0].get_to_id();
-        const int j_2 = edges[1].get_to_id();
+        const auto [j_1, j_2] = get_two_neighbors(graph, node_id);
         // if the added corner is flat, remove it
         if (shape.is_horizontal(node_id, j_1) == shape.is_horizontal(node_id, j_2))
             nodes_to_remove.push_back(node_id);
     }
     for (const int node_id : nodes_to_remove) {
-        const GraphNode& node = graph.get_node_by_id(node_id);
-        std::vector<GraphEdge> edges = node.get_edges();
-        const int j_1 = edges[0].get_to_id();
-        const int j_2 = edges[1].get_to_id();
+        const auto [j_1, j_2] = get_two_neighbors(graph, node_id);
         const Direction direction = shape.get_direction(j_1, node_id);
         graph.remove_node(node_id);
         graph.add_edge(j_1, j_2);
@@ -172,36 +142,65 @@ void remove_useless_bends(UndirectedSimpleGraph& graph,
 }
 
 DrawingResult make_orthogonal_drawing_incremental(const UndirectedSimpleGraph& graph,
-                                                  std::vector<Cycle>& cycles);
+                                                  std::vector<Cycle>& cycles,
+                                                  const DrawingOptions& options);
 
-DrawingResult make_orthogonal_drawing(const UndirectedSimpleGraph& graph) {
+DrawingResult make_orthogonal_drawing(const UndirectedSimpleGraph& graph,
+                                      const DrawingOptions& options) {
     std::vector<Cycle> cycles = compute_cycle_basis(graph);
-    return make_orthogonal_drawing_incremental(graph, cycles);
+    return make_orthogonal_drawing_incremental(graph, cycles, options);
+}
+
+Shape build_shape_with_options(UndirectedSimpleGraph& graph,
+                               GraphAttributes& attributes,
+                               std::vector<Cycle>& cycles,
+                               const DrawingOptions& options) {
+    if (options.split_biconnected_components) {
+        std::optional<Shape> shape = build_shape_by_biconnected_components(
+            graph, attributes, cycles, false, options.sat_options, options.split_options);
+        if (shape.has_value())
+            return std::move(*shape);
+    }
+    return build_shape(
+        graph, attributes, cycles, false, options.sat_options, options.split_options);
+}
+
+// cycles in the graph behind disjoint cycles of the ordering of the axis, all found by a single
+// search
+std::vector<Cycle> find_inconsistent_cycles(const ShapeOrderings& orderings,
+                                            const Axis axis,
+                                            const size_t max_number_of_cycles) {
+    const std::vector<Cycle> cycles_in_ordering =
+        find_disjoint_cycles_in_graph(orderings.get_ordering(axis), max_number_of_cycles);
+    std::vector<Cycle> cycles;
+    cycles.reserve(cycles_in_ordering.size());
+    for (const Cycle& cycle_in_ordering : cycles_in_ordering)
+        cycles.push_back(
+            build_cycle_in_graph_from_cycle_in_ordering(cycle_in_ordering, orderings, axis));
+    return cycles;
 }
 
-std::optional<Cycle> check_if_metrics_exist(Shape& shape, UndirectedSimpleGraph& graph) {
-    auto [classes_x, classes_y] = build_equivalence_classes(shape, graph);
-    auto [ordering_x, ordering_y, ordering_x_edge_to_graph_edge, ordering_y_edge_to_graph_edge] =
-        equivalence_classes_to_ordering(classes_x, classes_y, graph, shape);
-    std::optional<Cycle> cycle_x = find_a_cycle_in_graph(*ordering_x);
-    std::optional<Cycle> cycle_y = find_a_cycle_in_graph(*ordering_y);
-    if (cycle_x.has_value()) {
-        return build_cycle_in_graph_from_cycle_in_ordering(graph,
-                                                           shape,
-                                                           cycle_x.value(),
-                                                           *ordering_x,
-                                                           ordering_x_edge_to_graph_edge,
-                                                           false);
-    }
-    if (cycle_y.has_value()) {
-        return build_cycle_in_graph_from_cycle_in_ordering(graph,
-                                                           shape,
-                                                           cycle_y.value(),
-                                                           *ordering_y,
-                                                           ordering_y_edge_to_graph_edge,
-                                                           true);
-    }
-    return std::nullopt;
+// violated cycles of both orderings, x first, at most max_number_of_cycles (0 means no limit)
+std::vector<Cycle> check_if_metrics_exist(const ShapeOrderings& orderings,
+                                          const size_t max_number_of_cycles) {
+    const size_t limit =
+        max_number_of_cycles == 0 ? std::numeric_limits<size_t>::max() : max_number_of_cycles;
+    std::vector<Cycle> cycles = find_inconsistent_cycles(orderings, Axis::X, limit);
+    if (cycles.size() == limit)
+        return cycles;
+    // the same cycle of the graph can violate both orderings
+    const std::span<const Cycle> cycles_x(cycles.data(), cycles.size());
+    std::vector<Cycle> cycles_y;
+    for (Cycle& cycle : find_inconsistent_cycles(orderings, Axis::Y, limit - cycles.size())) {
+        const auto is_equivalent = [&](const Cycle& other) {
+            return are_cycles_equivalent(cycle, other);
+        };
+        if (!std::ranges::any_of(cycles_x, is_equivalent))
+            cycles_y.push_back(std::move(cycle));
+    }
+    for (Cycle& cycle : cycles_y)
+        cycles.push_back(std::move(cycle));
+    return cycles;
 }
 
 void build_nodes_positions(UndirectedSimpleGraph& graph, GraphAttributes& attributes, Shape& shape);
@@ -222,7 +221,8 @@ void make_shifts_overlapped_edges(UndirectedSimpleGraph& graph,
 void fix_negative_positions(const UndirectedSimpleGraph& graph, GraphAttributes& attributes);
 
 DrawingResult make_orthogonal_drawing_incremental(const UndirectedSimpleGraph& graph,
-                                                  std::vector<Cycle>& cycles) {
+                                                  std::vector<Cycle>& cycles,
+                                                  const DrawingOptions& options) {
     if (!is_graph_connected(graph))
         throw DisconnectedGraphError();
     auto augmented_graph = std::make_unique<UndirectedSimpleGraph>();
@@ -233,17 +233,23 @@ DrawingResult make_orthogonal_drawing_incremental(const UndirectedSimpleGraph& g
         attributes.set_node_color(node_id, Color::BLACK);
     }
     for (const GraphNode* node : graph.get_nodes())
-        for (const GraphEdge& edge : node->get_edges())
-            if (node->get_id() < edge.get_to_id())
-                augmented_graph->add_edge(node->get_id(), edge.get_to_id());
-    Shape shape = build_shape(*augmented_graph, attributes, cycles);
-    std::optional<Cycle> cycle_to_add = check_if_metrics_exist(shape, *augmented_graph);
+        for (const GraphNeighbor neighbor : node->get_neighbors())
+            if (node->get_id() < neighbor.id)
+                augmented_graph->add_edge(node->get_id(), neighbor.id);
+    Shape shape = build_shape_with_options(*augmented_graph, attributes, cycles, options);
+    // kept across the rounds, each round only patches the edges whose direction changed and
+    // the corners added by build_shape
+    ShapeOrderings orderings(*augmented_graph, shape);
+    std::vector<Cycle> cycles_to_add =
+        check_if_metrics_exist(orderings, options.max_cycles_per_round);
     size_t number_of_added_cycles = 0;
-    while (cycle_to_add.has_value()) {
-        cycles.push_back(std::move(*cycle_to_add));
-        number_of_added_cycles++;
-        shape = build_shape(*augmented_graph, attributes, cycles);
-        cycle_to_add = check_if_metrics_exist(shape, *augmented_graph);
+    while (!cycles_to_add.empty()) {
+        number_of_added_cycles += cycles_to_add.size();
+        for (Cycle& cycle : cycles_to_add)
+            cycles.push_back(std::move(cycle));
+        shape = build_shape_with_options(*augmented_graph, attributes, cycles, options);
+        orderings.update(*augmented_graph, shape);
+        cycles_to_add = check_if_metrics_exist(orderings, options.max_cycles_per_round);
     }
     const size_t old_size = augmented_graph->size();
     remove_useless_bends(*augmented_graph, attributes, shape);
@@ -259,7 +265,7 @@ DrawingResult make_orthogonal_drawing_incremental(const UndirectedSimpleGraph& g
     } else {
         build_nodes_positions(*augmented_graph, attributes, shape);
     }
-    compact_area(*augmented_graph, attributes);
+    compact_area(*augmented_graph, attributes, options.area_compaction);
     return {std::move(augmented_graph),
             std::move(attributes),
             std::move(shape),
@@ -268,17 +274,20 @@ DrawingResult make_orthogonal_drawing_incremental(const UndirectedSimpleGraph& g
             number_of_useless_bends};
 }
 
-void find_inconsistencies(UndirectedSimpleGraph& graph, Shape& shape, GraphAttributes& attributes);
+void find_inconsistencies(const UndirectedSimpleGraph& graph,
+                          Shape& shape,
+                          GraphAttributes& attributes,
+                          ShapeOrderings& orderings);
 
 void build_nodes_positions(UndirectedSimpleGraph& graph,
                            GraphAttributes& attributes,
                            Shape& shape) {
-    find_inconsistencies(graph, shape, attributes);
-    auto [classes_x, classes_y] = build_equivalence_classes(shape, graph);
-    auto [ordering_x, ordering_y, ignored_1, ignored_2] =
-        equivalence_classes_to_ordering(classes_x, classes_y, graph, shape);
-    auto new_classes_x_ordering = make_topological_ordering(*ordering_x);
-    auto new_classes_y_ordering = make_topological_ordering(*ordering_y);
+    ShapeOrderings orderings(graph, shape);
+    find_inconsistencies(graph, shape, attributes, orderings);
+    const EquivalenceClasses& classes_x = orderings.get_classes(Axis::X);
+    const EquivalenceClasses& classes_y = orderings.get_classes(Axis::Y);
+    auto new_classes_x_ordering = make_topological_ordering(orderings.get_ordering(Axis::X));
+    auto new_classes_y_ordering = make_topological_ordering(orderings.get_ordering(Axis::Y));
     int current_position_x = -100;
     std::unordered_map<int, int> node_id_to_position_x;
     for (const int class_id : new_classes_x_ordering) {
@@ -309,58 +318,82 @@ void build_nodes_positions(UndirectedSimpleGraph& graph,
     }
 }
 
-int min_coordinate(std::unordered_map<int, std::unordered_set<int>> coordinate_to_nodes) {
-    int min_c = INT_MAX;
-    for (const int coord : coordinate_to_nodes | std::views::keys)
-        if (coord < min_c)
-            min_c = coord;
-    return min_c;
+// index of each coordinate among the sorted distinct coordinates, the index grows only between
+// coordinates 100 apart; positions are read at the slots of the nodes
+std::vector<int> compute_coordinates_indices(const std::span<const size_t> slots,
+                                            const std::span<const int> positions) {
+    std::vector<int> coordinates;
+    coordinates.reserve(slots.size());
+    for (const size_t slot : slots)
+        coordinates.push_back(positions[slot]);
+    std::ranges::sort(coordinates);
+    coordinates.erase(std::ranges::unique(coordinates).begin(), coordinates.end());
+    std::vector<int> coordinate_index(coordinates.size(), 0);
+    for (size_t i = 1; i < coordinates.size(); ++i)
+        coordinate_index[i] =
+            coordinate_index[i - 1] + (coordinates[i] - coordinates[i - 1] == 100 ? 1 : 0);
+    std::vector<int> node_index;
+    node_index.reserve(slots.size());
+    for (const size_t slot : slots) {
+        const auto position = std::ranges::lower_bound(coordinates, positions[slot]);
+        node_index.push_back(coordinate_index[static_cast<size_t>(position - coordinates.begin())]);
+    }
+    return node_index;
+}
+
+IndexPositions compute_index_positions(const std::span<const int> nodes_ids,
+                                       const GraphAttributes& attributes) {
+    IndexPositions index_positions;
+    index_positions.node_index.reserve(nodes_ids.size());
+    std::vector<size_t> slots;
+    slots.reserve(nodes_ids.size());
+    for (const int node_id : nodes_ids) {
+        if (!attributes.has_position(node_id))
+            throw std::runtime_error("compute_index_positions: node does not have a position");
+        index_positions.node_index.add_node(node_id);
+        slots.push_back(attributes.get_node_slot(node_id));
+    }
+    index_positions.index_x = compute_coordinates_indices(slots, attributes.get_positions_x());
+    index_positions.index_y = compute_coordinates_indices(slots, attributes.get_positions_y());
+    return index_positions;
+}
+
+const IndexPositions& get_index_positions(const DrawingResult& result) {
+    if (!result.index_positions.has_value())
+        result.index_positions =
+            compute_index_positions(result.augmented_graph->get_nodes_ids(), result.attributes);
+    return *result.index_positions;
+}
+
+void compact_drawing(DrawingResult& result, const AreaCompaction compaction) {
+    compact_area(*result.augmented_graph, result.attributes, compaction);
+    result.index_positions.reset();
 }
 
 std::pair<std::unordered_map<int, int>, std::unordered_map<int, int>>
-compute_node_to_index_position(const UndirectedSimpleGraph& graph,
+compute_node_to_index_position(const std::vector<int>& nodes_ids,
                                const GraphAttributes& attributes) {
-    std::unordered_map<int, std::unordered_set<int>> coordinate_y_to_nodes;
-    for (const GraphNode* node : graph.get_nodes()) {
-        const int node_id = node->get_id();
-        const int y = attributes.get_position_y(node_id);
-        coordinate_y_to_nodes[y].insert(node_id);
-    }
-    std::unordered_map<int, std::unordered_set<int>> coordinate_x_to_nodes;
-    for (const GraphNode* node : graph.get_nodes()) {
-        const int node_id = node->get_id();
-        const int x = attributes.get_position_x(node_id);
-        coordinate_x_to_nodes[x].insert(node_id);
-    }
-    int y_index = 0;
-    std::unordered_map<int, int> node_to_coordinate_y;
-    int min_y = min_coordinate(coordinate_y_to_nodes);
-    while (true) {
-        for (const int node_id : coordinate_y_to_nodes[min_y])
-            node_to_coordinate_y[node_id] = y_index;
-        coordinate_y_to_nodes.erase(min_y);
-        if (coordinate_y_to_nodes.empty())
-            break;
-        const int next_min_y = min_coordinate(coordinate_y_to_nodes);
-        if (next_min_y - min_y == 100)
-            ++y_index;
-        min_y = next_min_y;
-    }
-    int x_index = 0;
+    const IndexPositions index_positions = compute_index_positions(nodes_ids, attributes);
     std::unordered_map<int, int> node_to_coordinate_x;
-    int min_x = min_coordinate(coordinate_x_to_nodes);
-    while (true) {
-        for (const int node_id : coordinate_x_to_nodes[min_x])
-            node_to_coordinate_x[node_id] = x_index;
-        coordinate_x_to_nodes.erase(min_x);
-        if (coordinate_x_to_nodes.empty())
-            break;
-        const int next_min_x = min_coordinate(coordinate_x_to_nodes);
-        if (next_min_x - min_x == 100)
-            ++x_index;
-        min_x = next_min_x;
-    }
-    return std::make_pair(node_to_coordinate_x, node_to_coordinate_y);
+    std::unordered_map<int, int> node_to_coordinate_y;
+    node_to_coordinate_x.reserve(nodes_ids.size());
+    node_to_coordinate_y.reserve(nodes_ids.size());
+    for (size_t i = 0; i < nodes_ids.size(); ++i) {
+        node_to_coordinate_x[nodes_ids[i]] = index_positions.index_x[i];
+        node_to_coordinate_y[nodes_ids[i]] = index_positions.index_y[i];
+    }
+    return std::make_pair(std::move(node_to_coordinate_x), std::move(node_to_coordinate_y));
+}
+
+std::pair<std::unordered_map<int, int>, std::unordered_map<int, int>>
+compute_node_to_index_position(const UndirectedSimpleGraph& graph,
+                               const GraphAttributes& attributes) {
+    return compute_node_to_index_position(graph.get_nodes_ids(), attributes);
+}
+
+std::pair<std::unordered_map<int, int>, std::unordered_map<int, int>>
+compute_node_to_index_position(const CsrGraph& graph, const GraphAttributes& attributes) {
+    return compute_node_to_index_position(graph.get_nodes_ids(), attributes);
 }
 
 auto find_edges_to_fix(const UndirectedSimpleGraph& graph,
@@ -378,16 +411,15 @@ auto find_edges_to_fix(const UndirectedSimpleGraph& graph,
         std::optional<int> downest_right = std::nullopt;
         std::optional<int> leftest_up = std::nullopt;
         std::optional<int> leftest_down = std::nullopt;
-        for (const GraphEdge& edge : node->get_edges()) {
-            const GraphNode& added = graph.get_node_by_id(edge.get_to_id());
-            const int added_id = added.get_id();
+        for (const GraphNeighbor neighbor : node->get_neighbors()) {
+            const int added_id = neighbor.id;
             if (shape.is_horizontal(node_id, added_id)) {
                 if (shape.is_left(node_id, added_id))
                     throw std::runtime_error("wtf 0");
                 int other_neighbor_id = 0;
                 bool found = false;
-                for (const GraphEdge& added_edge : added.get_edges()) {
-                    int neighbor_id = added_edge.get_to_id();
+                for (const GraphNeighbor added_neighbor : graph.get_neighbors(added_id)) {
+                    const int neighbor_id = added_neighbor.id;
                     if (neighbor_id == node_id)
                         continue;
                     found = true;
@@ -413,8 +445,8 @@ auto find_edges_to_fix(const UndirectedSimpleGraph& graph,
                     throw std::runtime_error("wtf 2");
                 int other_neighbor_id = 0;
                 bool found = false;
-                for (const GraphEdge& green_edge : added.get_edges()) {
-                    int neighbor_id = green_edge.get_to_id();
+                for (const GraphNeighbor green_neighbor : graph.get_neighbors(added_id)) {
+                    const int neighbor_id = green_neighbor.id;
                     if (neighbor_id == node_id)
                         continue;
                     found = true;
@@ -452,9 +484,9 @@ auto find_edges_to_fix(const UndirectedSimpleGraph& graph,
 int get_other_neighbor_id(const UndirectedSimpleGraph& graph,
                           const int node_id,
                           const int neighbor_id) {
-    for (const GraphEdge& edge : graph.get_node_by_id(node_id).get_edges()) {
-        if (edge.get_to_id() != neighbor_id) {
-            return edge.get_to_id();
+    for (const GraphNeighbor neighbor : graph.get_neighbors(node_id)) {
+        if (neighbor.id != neighbor_id) {
+            return neighbor.id;
         }
     }
     throw std::runtime_error("No other neighbor found for node " + std::to_string(node_id));
@@ -535,12 +567,13 @@ void add_green_blue_nodes(UndirectedSimpleGraph& graph, GraphAttributes& attribu
         for (auto [from_id, to_id] : edges_to_remove)
             graph.remove_edge(from_id, to_id);
     }
-    auto [classes_x, classes_y] = build_equivalence_classes(shape, graph);
-    auto ordering = equivalence_classes_to_ordering(classes_x, classes_y, graph, shape);
-    std::unique_ptr<DirectedSimpleGraph>& ordering_x = std::get<0>(ordering);
-    std::unique_ptr<DirectedSimpleGraph>& ordering_y = std::get<1>(ordering);
-    std::vector<int> classes_x_ordering = make_topological_ordering(*ordering_x);
-    std::vector<int> classes_y_ordering = make_topological_ordering(*ordering_y);
+    const ShapeOrderings orderings(graph, shape);
+    const EquivalenceClasses& classes_x = orderings.get_classes(Axis::X);
+    const EquivalenceClasses& classes_y = orderings.get_classes(Axis::Y);
+    const std::vector<int> classes_x_ordering =
+        make_topological_ordering(orderings.get_ordering(Axis::X));
+    const std::vector<int> classes_y_ordering =
+        make_topological_ordering(orderings.get_ordering(Axis::Y));
     int current_position_x = 0;
     std::unordered_map<int, int> node_id_to_position_x;
     for (const int class_id : classes_x_ordering) {
@@ -565,11 +598,12 @@ void add_green_blue_nodes(UndirectedSimpleGraph& graph, GraphAttributes& attribu
     attributes.remove_attribute(Attribute::NODES_POSITION);
 }
 
-void fix_inconsistency(const Cycle& cycle,
-                       GraphAttributes& attributes,
-                       const UndirectedSimpleGraph& graph,
-                       Shape& shape,
-                       const Color color_to_find) {
+// returns the edge whose direction has been changed
+std::pair<int, int> fix_inconsistency(const Cycle& cycle,
+                                      GraphAttributes& attributes,
+                                      const UndirectedSimpleGraph& graph,
+                                      Shape& shape,
+                                      const Color color_to_find) {
     const Direction direction = color_to_find == Color::GREEN ? Direction::UP : Direction::RIGHT;
     const Color dark_color = color_to_find == Color::GREEN ? Color::GREEN_DARK : Color::BLUE_DARK;
     std::optional<int> colored_node;
@@ -583,49 +617,47 @@ void fix_inconsistency(const Cycle& cycle,
     const int colored_node_id = colored_node.value();
     int neighbors_ids[2];
     int i = 0;
-    for (const GraphEdge& edge : graph.get_node_by_id(colored_node_id).get_edges()) {
-        neighbors_ids[i] = edge.get_to_id();
+    for (const GraphNeighbor neighbor : graph.get_neighbors(colored_node_id)) {
+        neighbors_ids[i] = neighbor.id;
         ++i;
     }
-    if (shape.is_up(neighbors_ids[0], colored_node_id)) {
-        shape.remove_direction(colored_node_id, neighbors_ids[0]);
-        shape.remove_direction(neighbors_ids[0], colored_node_id);
-        shape.set_direction(colored_node_id, neighbors_ids[0], direction);
-        shape.set_direction(neighbors_ids[0], colored_node_id, opposite_direction(direction));
-    } else {
-        shape.remove_direction(colored_node_id, neighbors_ids[1]);
-        shape.remove_direction(neighbors_ids[1], colored_node_id);
-        shape.set_direction(colored_node_id, neighbors_ids[1], direction);
-        shape.set_direction(neighbors_ids[1], colored_node_id, opposite_direction(direction));
-    }
+    const int neighbor_id =
+        shape.is_up(neighbors_ids[0], colored_node_id) ? neighbors_ids[0] : neighbors_ids[1];
+    shape.remove_direction(colored_node_id, neighbor_id);
+    shape.remove_direction(neighbor_id, colored_node_id);
+    shape.set_direction(colored_node_id, neighbor_id, direction);
+    shape.set_direction(neighbor_id, colored_node_id, opposite_direction(direction));
     attributes.change_node_color(colored_node_id, dark_color);
+    return {colored_node_id, neighbor_id};
 }
 
-void find_inconsistencies(UndirectedSimpleGraph& graph, Shape& shape, GraphAttributes& attributes) {
-    auto [classes_x, classes_y] = build_equivalence_classes(shape, graph);
-    auto [ordering_x, ordering_y, ordering_x_edge_to_graph_edge, ordering_y_edge_to_graph_edge] =
-        equivalence_classes_to_ordering(classes_x, classes_y, graph, shape);
-    std::optional<Cycle> cycle_x = find_a_cycle_in_graph(*ordering_x);
-    std::optional<Cycle> cycle_y = find_a_cycle_in_graph(*ordering_y);
-    if (cycle_x.has_value() || cycle_y.has_value()) {
-        if (cycle_x.has_value()) {
-            Cycle cycle = build_cycle_in_graph_from_cycle_in_ordering(graph,
-                                                                      shape,
-                                                                      cycle_x.value(),
-                                                                      *ordering_x,
-                                                                      ordering_x_edge_to_graph_edge,
-                                                                      false);
-            fix_inconsistency(cycle, attributes, graph, shape, Color::BLUE);
-        } else {
-            Cycle cycle = build_cycle_in_graph_from_cycle_in_ordering(graph,
-                                                                      shape,
-                                                                      cycle_y.value(),
-                                                                      *ordering_y,
-                                                                      ordering_y_edge_to_graph_edge,
-                                                                      true);
-            fix_inconsistency(cycle, attributes, graph, shape, Color::GREEN);
+// each search fixes all the disjoint inconsistencies it finds, patching the orderings after each
+// fix, a cycle through an endpoint of an edge changed by a previous fix is left to the next search
+void find_inconsistencies(const UndirectedSimpleGraph& graph,
+                          Shape& shape,
+                          GraphAttributes& attributes,
+                          ShapeOrderings& orderings) {
+    constexpr size_t no_limit = std::numeric_limits<size_t>::max();
+    while (true) {
+        Axis axis = Axis::X;
+        std::vector<Cycle> cycles = find_inconsistent_cycles(orderings, axis, no_limit);
+        if (cycles.empty()) {
+            axis = Axis::Y;
+            cycles = find_inconsistent_cycles(orderings, axis, no_limit);
+        }
+        if (cycles.empty())
+            return;
+        const Color color_to_find = axis == Axis::X ? Color::BLUE : Color::GREEN;
+        std::unordered_set<int> changed_nodes;
+        for (const Cycle& cycle : cycles) {
+            if (std::ranges::any_of(cycle, [&](int id) { return changed_nodes.contains(id); }))
+                continue;
+            const auto [from_id, to_id] =
+                fix_inconsistency(cycle, attributes, graph, shape, color_to_find);
+            orderings.change_direction(from_id, to_id, shape.get_direction(from_id, to_id));
+            changed_nodes.insert(from_id);
+            changed_nodes.insert(to_id);
         }
-        find_inconsistencies(graph, shape, attributes);
     }
 }
 
@@ -675,8 +707,6 @@ size_t find_fixed_index_node(const GraphAttributes& attributes,
     return nodes_at_direction.size() / 2;
 }
 
-enum class Axis { X, Y };
-
 void make_shifts(const int node_id,
                  UndirectedSimpleGraph& graph,
                  Shape& shape,
@@ -709,17 +739,21 @@ void make_shifts(const int node_id,
                                              };
     const size_t index_of_fixed_node = find_fixed_index_node(attributes, right_nodes);
     const int initial_position = position_function_other(attributes, node_id);
-    for (const GraphNode* node : graph.get_nodes()) {
-        const int old_position_y = position_function_other(attributes, node->get_id());
+    const std::span<const int> positions_other =
+        axis == Axis::X ? attributes.get_positions_y() : attributes.get_positions_x();
+    for (const int other_node_id : graph.get_node_index_map().get_nodes_ids()) {
+        if (!attributes.has_position(other_node_id))
+            throw std::runtime_error("make_shifts: node does not have a position");
+        const int old_position_y = positions_other[attributes.get_node_slot(other_node_id)];
         if (old_position_y > initial_position) {
             const auto node_count = static_cast<int>(right_nodes.size());
             const int offset = node_count - static_cast<int>(index_of_fixed_node) - 1;
             const int new_position_y = old_position_y + 5 * offset;
-            change_position_other(attributes, node->get_id(), new_position_y);
+            change_position_other(attributes, other_node_id, new_position_y);
         }
         if (old_position_y < initial_position) {
             const int new_position_y = old_position_y - 5 * static_cast<int>(index_of_fixed_node);
-            change_position_other(attributes, node->get_id(), new_position_y);
+            change_position_other(attributes, other_node_id, new_position_y);
         }
     }
     for (size_t i = 0; i < right_nodes.size(); ++i) {
@@ -758,8 +792,8 @@ void make_shifts(const int node_id,
 
 auto neighbors_at_each_direction(const GraphNode& node, const Shape& shape) {
     std::unordered_map<Direction, std::vector<int>> nodes_at_direction;
-    for (const GraphEdge& edge : node.get_edges()) {
-        const int neighbor_id = edge.get_to_id();
+    for (const GraphNeighbor neighbor : node.get_neighbors()) {
+        const int neighbor_id = neighbor.id;
         const Direction dir = shape.get_direction(node.get_id(), neighbor_id);
         nodes_at_direction[dir].push_back(neighbor_id);
     }
@@ -1,61 +1,91 @@
 #include "orthogonal/drawing_stats.hpp"
 
+#include <algorithm>
 #include <cmath>
-#include <functional>
-#include <unordered_set>
+#include <ranges>
+#include <span>
+#include <tuple>
 #include <vector>
 
-std::vector<int> compute_edge_lengths(const UndirectedSimpleGraph& graph,
-                                      const GraphAttributes& attributes) {
-    auto [node_to_coordinate_x, node_to_coordinate_y] =
-        compute_node_to_index_position(graph, attributes);
-    std::vector<int> edge_lengths;
-    std::unordered_set<int> visited;
-    for (const int node_id : graph.get_nodes_ids()) {
-        if (attributes.get_node_color(node_id) != Color::BLACK)
+// index positions of the nodes of the graph, addressed by the dense index of the csr graph
+std::pair<std::vector<int>, std::vector<int>>
+compute_csr_index_positions(const CsrGraph& graph, const IndexPositions& index_positions) {
+    if (std::ranges::equal(graph.get_nodes_ids(), index_positions.node_index.get_nodes_ids()))
+        return std::make_pair(index_positions.index_x, index_positions.index_y);
+    std::vector<int> index_x(graph.size());
+    std::vector<int> index_y(graph.size());
+    for (size_t node = 0; node < graph.size(); ++node) {
+        const size_t index = index_positions.node_index.get_index(graph.get_node_id(node));
+        index_x[node] = index_positions.index_x[index];
+        index_y[node] = index_positions.index_y[index];
+    }
+    return std::make_pair(std::move(index_x), std::move(index_y));
+}
+
+std::vector<bool> compute_black_nodes(const CsrGraph& graph, const GraphAttributes& attributes) {
+    std::vector<bool> is_black(graph.size());
+    for (size_t node = 0; node < graph.size(); ++node)
+        is_black[node] = attributes.get_node_color(graph.get_node_id(node)) == Color::BLACK;
+    return is_black;
+}
+
+// walks the chains of non black nodes leaving the black node black_id, every chain reaching a
+// black node with a larger id is an edge of the original graph: its length and its bends (a bend
+// for every corner whose neighbors along the chain are not in the same index position) are stored
+void edge_chains_dfs(const CsrGraph& graph,
+                     const std::vector<bool>& is_black,
+                     const std::vector<int>& index_x,
+                     const std::vector<int>& index_y,
+                     std::vector<bool>& visited,
+                     std::vector<std::pair<int, int>>& edges,
+                     std::vector<int>& edge_lengths,
+                     std::vector<int>& bends_counts,
+                     const size_t current,
+                     const size_t previous,
+                     const int black_id,
+                     const int current_length,
+                     int current_bends) {
+    visited[current] = true;
+    for (const size_t neighbor : graph.get_neighbors(current)) {
+        if (visited[neighbor])
             continue;
-        std::function<void(int, int, int)> dfs =
-            [&](const int current_id, const int black_id, const int current_length) {
-                visited.insert(current_id);
-                for (const GraphEdge& edge : graph.get_node_by_id(current_id).get_edges()) {
-                    const int neighbor = edge.get_to_id();
-                    if (visited.contains(neighbor))
-                        continue;
-                    const int x1 = node_to_coordinate_x[current_id];
-                    const int y1 = node_to_coordinate_y[current_id];
-                    const int x2 = node_to_coordinate_x[neighbor];
-                    const int y2 = node_to_coordinate_y[neighbor];
-                    const int length = std::abs(x1 - x2) + std::abs(y1 - y2);
-                    const Color neighbor_color = attributes.get_node_color(neighbor);
-                    if (neighbor_color != Color::BLACK)
-                        dfs(neighbor, black_id, current_length + length);
-                    else {
-                        if (black_id < neighbor) {
-                            int total_length = current_length + length;
-                            edge_lengths.push_back(total_length);
-                        }
-                    }
-                }
-                visited.erase(current_id);
-            };
-        dfs(node_id, node_id, 0);
+        const int length = std::abs(index_x[current] - index_x[neighbor]) +
+                           std::abs(index_y[current] - index_y[neighbor]);
+        if (!is_black[neighbor]) {
+            const bool is_flat =
+                index_x[previous] == index_x[neighbor] && index_y[previous] == index_y[neighbor];
+            edge_chains_dfs(graph,
+                            is_black,
+                            index_x,
+                            index_y,
+                            visited,
+                            edges,
+                            edge_lengths,
+                            bends_counts,
+                            neighbor,
+                            current,
+                            black_id,
+                            current_length + length,
+                            is_flat ? current_bends : current_bends + 1);
+        } else if (black_id < graph.get_node_id(neighbor)) {
+            if (length == 0)
+                current_bends--;
+            edges.emplace_back(black_id, graph.get_node_id(neighbor));
+            edge_lengths.push_back(current_length + length);
+            bends_counts.push_back(current_bends);
+        }
     }
-    return edge_lengths;
+    visited[current] = false;
 }
 
-int compute_total_edge_length(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const std::vector<int> edge_lengths = compute_edge_lengths(graph, result.attributes);
+int compute_total_edge_length(const std::vector<int>& edge_lengths) {
     int total_edge_length = 0;
     for (const int length : edge_lengths)
         total_edge_length += length;
     return total_edge_length;
 }
 
-int compute_max_edge_length(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const GraphAttributes& attributes = result.attributes;
-    const std::vector<int> edge_lengths = compute_edge_lengths(graph, attributes);
+int compute_max_edge_length(const std::vector<int>& edge_lengths) {
     int max_edge_length = 0;
     for (const int length : edge_lengths)
         if (length > max_edge_length)
@@ -63,65 +93,32 @@ int compute_max_edge_length(const DrawingResult& result) {
     return max_edge_length;
 }
 
-double compute_edge_length_std_dev(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const GraphAttributes& attributes = result.attributes;
-    const std::vector<int> edge_lengths = compute_edge_lengths(graph, attributes);
-    return compute_stddev(edge_lengths);
+int compute_total_edge_length(const DrawingResult& result) {
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_total_edge_length(engine.get_edge_lengths());
 }
 
-std::vector<int> compute_bends_counts(const UndirectedSimpleGraph& graph,
-                                      const GraphAttributes& attributes) {
-    auto [node_to_coordinate_x, node_to_coordinate_y] =
-        compute_node_to_index_position(graph, attributes);
-    std::vector<int> bends_counts;
-    for (const GraphNode* node : graph.get_nodes()) {
-        if (attributes.get_node_color(node->get_id()) != Color::BLACK)
-            continue;
-        std::unordered_set<int> visited;
-        std::function<void(int, int, int, int)> dfs =
-            [&](int current, int black, int count, int previous_id) {
-                visited.insert(current);
-                for (const GraphEdge& edge : graph.get_node_by_id(current).get_edges()) {
-                    const int neighbor_id = edge.get_to_id();
-                    if (visited.contains(neighbor_id))
-                        continue;
-                    const Color neighbor_color = attributes.get_node_color(neighbor_id);
-                    if (neighbor_color != Color::BLACK) {
-                        if (node_to_coordinate_x[previous_id] ==
-                                node_to_coordinate_x[neighbor_id] &&
-                            node_to_coordinate_y[previous_id] == node_to_coordinate_y[neighbor_id])
-                            dfs(neighbor_id, black, count, current);
-                        else
-                            dfs(neighbor_id, black, count + 1, current);
-                    } else if (black < neighbor_id) {
-                        if (node_to_coordinate_x[current] == node_to_coordinate_x[neighbor_id] &&
-                            node_to_coordinate_y[current] == node_to_coordinate_y[neighbor_id])
-                            count--;
-                        bends_counts.push_back(count);
-                    }
-                }
-                visited.erase(current);
-            };
-        dfs(node->get_id(), node->get_id(), 0, node->get_id());
-    }
-    return bends_counts;
+int compute_max_edge_length(const DrawingResult& result) {
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_max_edge_length(engine.get_edge_lengths());
 }
 
-int compute_total_bends(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const GraphAttributes& attributes = result.attributes;
-    const std::vector<int> bends_counts = compute_bends_counts(graph, attributes);
+double compute_edge_length_std_dev(const DrawingResult& result) {
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_stddev(engine.get_edge_lengths());
+}
+
+int compute_total_bends(const std::vector<int>& bends_counts) {
     int total_bends = 0;
     for (const int count : bends_counts)
         total_bends += count;
     return total_bends;
 }
 
-int compute_max_bends_per_edge(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const GraphAttributes& attributes = result.attributes;
-    const std::vector<int> bends_counts = compute_bends_counts(graph, attributes);
+int compute_max_bends_per_edge(const std::vector<int>& bends_counts) {
     int max_bends = 0;
     for (const int count : bends_counts)
         if (count > max_bends)
@@ -129,31 +126,43 @@ int compute_max_bends_per_edge(const DrawingResult& result) {
     return max_bends;
 }
 
+int compute_total_bends(const DrawingResult& result) {
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_total_bends(engine.get_bends_counts());
+}
+
+int compute_max_bends_per_edge(const DrawingResult& result) {
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_max_bends_per_edge(engine.get_bends_counts());
+}
+
 double compute_bends_std_dev(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    const auto& attributes = result.attributes;
-    return compute_stddev(compute_bends_counts(graph, attributes));
+    const CsrGraph graph(*result.augmented_graph);
+    const OrthogonalStatsEngine engine(graph, result.attributes, get_index_positions(result));
+    return compute_stddev(engine.get_bends_counts());
 }
 
-int compute_total_area(const DrawingResult& result) {
-    const UndirectedSimpleGraph& graph = *result.augmented_graph;
-    auto [node_to_coordinate_x, node_to_coordinate_y] =
-        compute_node_to_index_position(graph, result.attributes);
+int compute_total_area(const std::vector<int>& index_x, const std::vector<int>& index_y) {
     int max_x = -INT_MAX;
     int max_y = -INT_MAX;
     int min_x = INT_MAX;
     int min_y = INT_MAX;
-    for (const int node_id : graph.get_nodes_ids()) {
-        const int x = node_to_coordinate_x[node_id];
-        const int y = node_to_coordinate_y[node_id];
-        max_x = std::max(max_x, x);
-        max_y = std::max(max_y, y);
-        min_x = std::min(min_x, x);
-        min_y = std::min(min_y, y);
+    for (size_t node = 0; node < index_x.size(); ++node) {
+        max_x = std::max(max_x, index_x[node]);
+        max_y = std::max(max_y, index_y[node]);
+        min_x = std::min(min_x, index_x[node]);
+        min_y = std::min(min_y, index_y[node]);
     }
     return (max_x - min_x + 1) * (max_y - min_y + 1);
 }
 
+int compute_total_area(const DrawingResult& result) {
+    const IndexPositions& index_positions = get_index_positions(result);
+    return compute_total_area(index_positions.index_x, index_positions.index_y);
+}
+
 bool do_edges_cross(const int i,
                     const int j,
                     const int k,
@@ -188,16 +197,20 @@ bool do_edges_cross(const int i,
     return true;
 }
 
-bool do_edges_cross(
-    const GraphAttributes& attributes, const int i, const int j, const int k, const int l) {
-    const int i_pos_x = attributes.get_position_x(i);
-    const int i_pos_y = attributes.get_position_y(i);
-    const int j_pos_x = attributes.get_position_x(j);
-    const int j_pos_y = attributes.get_position_y(j);
-    const int k_pos_x = attributes.get_position_x(k);
-    const int k_pos_y = attributes.get_position_y(k);
-    const int l_pos_x = attributes.get_position_x(l);
-    const int l_pos_y = attributes.get_position_y(l);
+bool do_edges_cross(const std::span<const int> positions_x,
+                    const std::span<const int> positions_y,
+                    const size_t i,
+                    const size_t j,
+                    const size_t k,
+                    const size_t l) {
+    const int i_pos_x = positions_x[i];
+    const int i_pos_y = positions_y[i];
+    const int j_pos_x = positions_x[j];
+    const int j_pos_y = positions_y[j];
+    const int k_pos_x = positions_x[k];
+    const int k_pos_y = positions_y[k];
+    const int l_pos_x = positions_x[l];
+    const int l_pos_y = positions_y[l];
 
     if (std::abs(i_pos_x - k_pos_x) < 0.2 || std::abs(i_pos_x - l_pos_x) < 0.2 ||
         std::abs(i_pos_y - k_pos_y) < 0.2 || std::abs(i_pos_y - l_pos_y) < 0.2 ||
@@ -221,7 +234,7 @@ bool do_edges_cross(
                                         (j_pos_y <= l_pos_y && i_pos_y >= l_pos_y));
     }
     if (!is_i_j_horizontal)
-        return do_edges_cross(attributes, k, l, i, j);
+        return do_edges_cross(positions_x, positions_y, k, l, i, j);
     if (k_pos_x < std::min(i_pos_x, j_pos_x) || k_pos_x > std::max(i_pos_x, j_pos_x))
         return false;
     if (i_pos_y < std::min(k_pos_y, l_pos_y) || i_pos_y > std::max(k_pos_y, l_pos_y))
@@ -229,43 +242,177 @@ bool do_edges_cross(
     return true;
 }
 
-int compute_total_crossings(const DrawingResult& result) {
-    const auto& graph = *result.augmented_graph;
-    const GraphAttributes& attributes = result.attributes;
-    auto [node_to_coordinate_x, node_to_coordinate_y] =
-        compute_node_to_index_position(graph, attributes);
+// number of values added at each position of [0, size), with prefix sums in O(log size)
+class FenwickTree {
+    std::vector<int> m_counts;
+
+  public:
+    explicit FenwickTree(const size_t size) : m_counts(size + 1, 0) {}
+    void add(size_t position, const int value) {
+        for (++position; position < m_counts.size(); position += position & (~position + 1))
+            m_counts[position] += value;
+    }
+    // sum over the positions before the given one
+    [[nodiscard]] int prefix_sum(size_t position) const {
+        int sum = 0;
+        for (; position > 0; position -= position & (~position + 1))
+            sum += m_counts[position];
+        return sum;
+    }
+};
+
+// at the same x, horizontal segments end before vertical ones are queried and start after, since
+// segments touching at an end do not cross
+enum class SweepEventType { REMOVE_HORIZONTAL, QUERY_VERTICAL, ADD_HORIZONTAL };
+
+struct SweepEvent {
+    int x;
+    SweepEventType type;
+    size_t segment;
+};
+
+// same count as checking do_edges_cross on every pair of edges going from a smaller id to a
+// larger one (the others are not counted): because equal coordinates never cross there, only an
+// horizontal edge and a vertical one crossing in both their interiors count, the pairs of
+// horizontal edges with edges that are neither horizontal nor vertical are still checked one by one
+int compute_total_crossings(const CsrGraph& graph, const GraphAttributes& attributes) {
+    for (const int node_id : graph.get_nodes_ids())
+        if (!attributes.has_position(node_id))
+            throw std::runtime_error("compute_total_crossings: node does not have a position");
+    const std::span<const int> positions_x = attributes.get_positions_x();
+    const std::span<const int> positions_y = attributes.get_positions_y();
+    std::vector<std::pair<size_t, size_t>> horizontal_edges;
+    std::vector<std::pair<size_t, size_t>> vertical_edges;
+    std::vector<std::pair<size_t, size_t>> other_edges;
+    for (const CsrEdge& edge : graph.get_edges()) {
+        const int from_id = graph.get_node_id(edge.from_index);
+        const int to_id = graph.get_node_id(edge.to_index);
+        if (from_id > to_id)
+            continue;
+        const size_t from = attributes.get_node_slot(from_id);
+        const size_t to = attributes.get_node_slot(to_id);
+        const bool same_x = positions_x[from] == positions_x[to];
+        const bool same_y = positions_y[from] == positions_y[to];
+        if (same_y && !same_x)
+            horizontal_edges.emplace_back(from, to);
+        else if (same_x && !same_y)
+            vertical_edges.emplace_back(from, to);
+        else if (!same_x && !same_y)
+            other_edges.emplace_back(from, to);
+    }
+    std::vector<int> ys;
+    ys.reserve(horizontal_edges.size());
+    for (const size_t from : horizontal_edges | std::views::keys)
+        ys.push_back(positions_y[from]);
+    std::ranges::sort(ys);
+    ys.erase(std::ranges::unique(ys).begin(), ys.end());
+    const auto y_rank = [&ys](const int y) {
+        return static_cast<size_t>(std::ranges::lower_bound(ys, y) - ys.begin());
+    };
+    std::vector<SweepEvent> events;
+    events.reserve(2 * horizontal_edges.size() + vertical_edges.size());
+    for (size_t i = 0; i < horizontal_edges.size(); ++i) {
+        const auto [from, to] = horizontal_edges[i];
+        const auto [min_x, max_x] = std::minmax(positions_x[from], positions_x[to]);
+        events.push_back({min_x, SweepEventType::ADD_HORIZONTAL, i});
+        events.push_back({max_x, SweepEventType::REMOVE_HORIZONTAL, i});
+    }
+    for (size_t i = 0; i < vertical_edges.size(); ++i)
+        events.push_back({positions_x[vertical_edges[i].first], SweepEventType::QUERY_VERTICAL, i});
+    std::ranges::sort(events, [](const SweepEvent& a, const SweepEvent& b) {
+        return std::tie(a.x, a.type) < std::tie(b.x, b.type);
+    });
+    FenwickTree active_ys(ys.size());
     int total_crossings = 0;
-    std::vector<GraphEdge> edges = graph.get_edges();
-    for (GraphEdge& edge : edges) {
-        const int edge_id = edge.get_id();
-        const int i = edge.get_from_id();
-        const int j = edge.get_to_id();
-        if (i > j)
+    for (const SweepEvent& event : events) {
+        if (event.type == SweepEventType::QUERY_VERTICAL) {
+            const auto [from, to] = vertical_edges[event.segment];
+            const auto [min_y, max_y] = std::minmax(positions_y[from], positions_y[to]);
+            // active horizontal edges with min_y < y < max_y
+            total_crossings +=
+                active_ys.prefix_sum(y_rank(max_y)) - active_ys.prefix_sum(y_rank(min_y + 1));
             continue;
-        for (GraphEdge& other_edge : edges) {
-            const int other_edge_id = other_edge.get_id();
-            if (edge_id >= other_edge_id)
-                continue;
-            const int k = other_edge.get_from_id();
-            const int l = other_edge.get_to_id();
-            if (k > l)
-                continue;
-            if (i == k || i == l || j == k || j == l)
-                continue;
-            if (do_edges_cross(attributes, i, j, k, l))
-                ++total_crossings;
         }
+        const size_t y = y_rank(positions_y[horizontal_edges[event.segment].first]);
+        active_ys.add(y, event.type == SweepEventType::ADD_HORIZONTAL ? 1 : -1);
     }
+    for (const auto& [i, j] : other_edges)
+        for (const auto& [k, l] : horizontal_edges)
+            if (do_edges_cross(positions_x, positions_y, i, j, k, l))
+                ++total_crossings;
     return total_crossings;
 }
 
+int compute_total_crossings(const DrawingResult& result) {
+    return compute_total_crossings(CsrGraph(*result.augmented_graph), result.attributes);
+}
+
 OrthogonalStats compute_all_orthogonal_stats(const DrawingResult& result) {
-    return {compute_total_crossings(result),
-            compute_total_bends(result),
-            compute_total_area(result),
-            compute_total_edge_length(result),
-            compute_max_edge_length(result),
-            compute_edge_length_std_dev(result),
-            compute_max_bends_per_edge(result),
-            compute_bends_std_dev(result)};
+    return compute_all_orthogonal_stats(result, CsrGraph(*result.augmented_graph));
+}
+
+OrthogonalStatsEngine::OrthogonalStatsEngine(const CsrGraph& graph,
+                                             const GraphAttributes& attributes)
+    : OrthogonalStatsEngine(graph,
+                            attributes,
+                            compute_index_positions(graph.get_nodes_ids(), attributes)) {}
+
+OrthogonalStatsEngine::OrthogonalStatsEngine(const CsrGraph& graph,
+                                             const GraphAttributes& attributes,
+                                             const IndexPositions& index_positions)
+    : m_graph(graph), m_attributes(attributes) {
+    auto [index_x, index_y] = compute_csr_index_positions(graph, index_positions);
+    m_index_x = std::move(index_x);
+    m_index_y = std::move(index_y);
+    const std::vector<bool> is_black = compute_black_nodes(graph, attributes);
+    std::vector<bool> visited(graph.size(), false);
+    for (size_t node = 0; node < graph.size(); ++node) {
+        if (!is_black[node])
+            continue;
+        edge_chains_dfs(graph,
+                        is_black,
+                        m_index_x,
+                        m_index_y,
+                        visited,
+                        m_edges,
+                        m_edge_lengths,
+                        m_bends_counts,
+                        node,
+                        node,
+                        graph.get_node_id(node),
+                        0,
+                        0);
+    }
+}
+
+const std::vector<std::pair<int, int>>& OrthogonalStatsEngine::get_edges() const {
+    return m_edges;
+}
+
+const std::vector<int>& OrthogonalStatsEngine::get_edge_lengths() const { return m_edge_lengths; }
+
+const std::vector<int>& OrthogonalStatsEngine::get_bends_counts() const { return m_bends_counts; }
+
+int OrthogonalStatsEngine::compute_total_area() const {
+    return ::compute_total_area(m_index_x, m_index_y);
+}
+
+int OrthogonalStatsEngine::compute_total_crossings() const {
+    return ::compute_total_crossings(m_graph, m_attributes);
+}
+
+OrthogonalStats OrthogonalStatsEngine::compute_stats() const {
+    return {compute_total_crossings(),
+            compute_total_bends(m_bends_counts),
+            compute_total_area(),
+            compute_total_edge_length(m_edge_lengths),
+            compute_max_edge_length(m_edge_lengths),
+            compute_stddev(m_edge_lengths),
+            compute_max_bends_per_edge(m_bends_counts),
+            compute_stddev(m_bends_counts)};
+}
+
+OrthogonalStats compute_all_orthogonal_stats(const DrawingResult& result, const CsrGraph& graph) {
+    return OrthogonalStatsEngine(graph, result.attributes, get_index_positions(result))
+        .compute_stats();
 }
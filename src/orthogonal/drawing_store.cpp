@@ -0,0 +1,254 @@
+#include "orthogonal/drawing_store.hpp"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "orthogonal/file_loader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t fnv1a_hash(const std::string_view bytes) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char byte : bytes) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// index.bin: magic, version, capacity, number of entries, then capacity slots of
+// (key, offset, length) in data.bin, key 0 marks an empty slot
+constexpr std::array<char, 8> INDEX_MAGIC = {'D', 'O', 'M', 'U', 'S', 'I', 'D', 'X'};
+constexpr uint64_t INDEX_VERSION = 2;
+constexpr size_t INDEX_HEADER_SIZE = 4 * sizeof(uint64_t);
+constexpr size_t INDEX_SLOT_SIZE = 3 * sizeof(uint64_t);
+constexpr uint64_t INITIAL_CAPACITY = 1024;
+
+uint64_t read_word(const char* bytes, const size_t position) {
+    uint64_t word;
+    std::memcpy(&word, bytes + position, sizeof(word));
+    return word;
+}
+
+void write_word(char* bytes, const size_t position, const uint64_t word) {
+    std::memcpy(bytes + position, &word, sizeof(word));
+}
+
+size_t slot_position(const size_t slot) { return INDEX_HEADER_SIZE + slot * INDEX_SLOT_SIZE; }
+
+// 0 is the empty slot
+uint64_t normalize_key(const uint64_t key) { return key == 0 ? 1 : key; }
+
+// the time, then the binary drawing
+std::string drawing_to_record(const DrawingResult& result, const double time) {
+    std::string record(sizeof(time), 0);
+    std::memcpy(record.data(), &time, sizeof(time));
+    record += drawing_result_to_binary(result);
+    return record;
+}
+
+StoredDrawing record_to_drawing(const std::span<const char> record) {
+    double time;
+    if (record.size() < sizeof(time))
+        throw std::runtime_error("DrawingStore: invalid drawing");
+    std::memcpy(&time, record.data(), sizeof(time));
+    return {DrawingResultView(record.subspan(sizeof(time))).to_drawing_result(), time};
+}
+
+DrawingStore::DrawingStore(std::string folder) : m_folder(std::move(folder)) {
+    std::filesystem::create_directories(m_folder);
+    const std::string data_path = (std::filesystem::path(m_folder) / "data.bin").string();
+    m_data_fd = open(data_path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (m_data_fd < 0)
+        throw std::runtime_error("DrawingStore: could not open " + data_path);
+    struct stat data_stat{};
+    if (fstat(m_data_fd, &data_stat) != 0)
+        throw std::runtime_error("DrawingStore: could not read the size of " + data_path);
+    m_data_size = static_cast<size_t>(data_stat.st_size);
+    const std::string index_path = (std::filesystem::path(m_folder) / "index.bin").string();
+    if (!std::filesystem::exists(index_path)) {
+        create_index(index_path, INITIAL_CAPACITY);
+        return;
+    }
+    m_index_fd = open(index_path.c_str(), O_RDWR);
+    if (m_index_fd < 0)
+        throw std::runtime_error("DrawingStore: could not open " + index_path);
+    struct stat index_stat{};
+    if (fstat(m_index_fd, &index_stat) != 0)
+        throw std::runtime_error("DrawingStore: could not read the size of " + index_path);
+    const auto index_size = static_cast<size_t>(index_stat.st_size);
+    if (index_size < INDEX_HEADER_SIZE)
+        throw std::runtime_error("DrawingStore: invalid index " + index_path);
+    map_index(index_size);
+    if (std::memcmp(m_index, INDEX_MAGIC.data(), INDEX_MAGIC.size()) != 0 ||
+        read_word(m_index, sizeof(uint64_t)) != INDEX_VERSION ||
+        slot_position(get_capacity()) != index_size)
+        throw std::runtime_error("DrawingStore: invalid index " + index_path);
+}
+
+DrawingStore::~DrawingStore() {
+    unmap_index();
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_data_mapped_size);
+    if (m_index_fd >= 0)
+        close(m_index_fd);
+    if (m_data_fd >= 0)
+        close(m_data_fd);
+}
+
+void DrawingStore::map_index(const size_t size) {
+    void* index = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_index_fd, 0);
+    if (index == MAP_FAILED)
+        throw std::runtime_error("DrawingStore: could not map the index");
+    m_index = static_cast<char*>(index);
+    m_index_size = size;
+}
+
+void DrawingStore::unmap_index() {
+    if (m_index != nullptr)
+        munmap(m_index, m_index_size);
+    m_index = nullptr;
+    m_index_size = 0;
+}
+
+void DrawingStore::create_index(const std::string& path, const uint64_t capacity) {
+    m_index_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_index_fd < 0)
+        throw std::runtime_error("DrawingStore: could not create " + path);
+    const size_t size = slot_position(capacity);
+    if (ftruncate(m_index_fd, static_cast<off_t>(size)) != 0)
+        throw std::runtime_error("DrawingStore: could not resize " + path);
+    map_index(size);
+    std::memcpy(m_index, INDEX_MAGIC.data(), INDEX_MAGIC.size());
+    write_word(m_index, sizeof(uint64_t), INDEX_VERSION);
+    write_word(m_index, 2 * sizeof(uint64_t), capacity);
+    write_word(m_index, 3 * sizeof(uint64_t), 0);
+}
+
+// the entries go to a new index, which then replaces the old one
+void DrawingStore::grow_index() {
+    std::vector<std::array<uint64_t, 3>> entries;
+    for (size_t slot = 0; slot < get_capacity(); ++slot) {
+        const size_t position = slot_position(slot);
+        const uint64_t key = read_word(m_index, position);
+        if (key != 0)
+            entries.push_back({key,
+                               read_word(m_index, position + sizeof(uint64_t)),
+                               read_word(m_index, position + 2 * sizeof(uint64_t))});
+    }
+    const uint64_t capacity = 2 * get_capacity();
+    unmap_index();
+    close(m_index_fd);
+    const std::filesystem::path index_path = std::filesystem::path(m_folder) / "index.bin";
+    const std::string new_index_path = index_path.string() + ".new";
+    create_index(new_index_path, capacity);
+    for (const auto& [key, offset, length] : entries) {
+        const size_t position = slot_position(find_slot(key));
+        write_word(m_index, position + sizeof(uint64_t), offset);
+        write_word(m_index, position + 2 * sizeof(uint64_t), length);
+        write_word(m_index, position, key);
+    }
+    write_word(m_index, 3 * sizeof(uint64_t), entries.size());
+    std::filesystem::rename(new_index_path, index_path);
+}
+
+void DrawingStore::map_data() {
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_data_mapped_size);
+    m_data = nullptr;
+    m_data_mapped_size = 0;
+    if (m_data_size == 0)
+        return;
+    void* data = mmap(nullptr, m_data_size, PROT_READ, MAP_SHARED, m_data_fd, 0);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("DrawingStore: could not map the data");
+    m_data = static_cast<const char*>(data);
+    m_data_mapped_size = m_data_size;
+}
+
+uint64_t DrawingStore::get_capacity() const { return read_word(m_index, 2 * sizeof(uint64_t)); }
+
+uint64_t DrawingStore::get_number_of_entries() const {
+    return read_word(m_index, 3 * sizeof(uint64_t));
+}
+
+size_t DrawingStore::find_slot(const uint64_t key) const {
+    const uint64_t capacity = get_capacity();
+    size_t slot = key % capacity;
+    while (true) {
+        const uint64_t slot_key = read_word(m_index, slot_position(slot));
+        if (slot_key == key || slot_key == 0)
+            return slot;
+        slot = (slot + 1) % capacity;
+    }
+}
+
+// an entry pointing past the end of the data (the process died while writing) is missing
+bool DrawingStore::has_entry(const size_t position, const uint64_t key) const {
+    if (read_word(m_index, position) != key)
+        return false;
+    const uint64_t offset = read_word(m_index, position + sizeof(uint64_t));
+    const uint64_t length = read_word(m_index, position + 2 * sizeof(uint64_t));
+    return offset + length <= m_data_size;
+}
+
+bool DrawingStore::contains(const uint64_t key) const {
+    std::lock_guard lock(m_mutex);
+    const uint64_t normalized_key = normalize_key(key);
+    return has_entry(slot_position(find_slot(normalized_key)), normalized_key);
+}
+
+std::optional<StoredDrawing> DrawingStore::find(const uint64_t key) {
+    std::lock_guard lock(m_mutex);
+    const uint64_t normalized_key = normalize_key(key);
+    const size_t position = slot_position(find_slot(normalized_key));
+    if (!has_entry(position, normalized_key))
+        return std::nullopt;
+    const uint64_t offset = read_word(m_index, position + sizeof(uint64_t));
+    const uint64_t length = read_word(m_index, position + 2 * sizeof(uint64_t));
+    if (offset + length > m_data_mapped_size)
+        map_data();
+    return record_to_drawing({m_data + offset, static_cast<size_t>(length)});
+}
+
+// the drawing is appended to the data before the index points to it, a missing entry of the key
+// is overwritten
+void DrawingStore::insert(const uint64_t key, const DrawingResult& result, const double time) {
+    const std::string record = drawing_to_record(result, time);
+    std::lock_guard lock(m_mutex);
+    const uint64_t normalized_key = normalize_key(key);
+    const size_t old_position = slot_position(find_slot(normalized_key));
+    if (has_entry(old_position, normalized_key))
+        return;
+    const bool is_new_key = read_word(m_index, old_position) != normalized_key;
+    size_t written = 0;
+    while (written < record.size()) {
+        const ssize_t bytes = write(m_data_fd, record.data() + written, record.size() - written);
+        if (bytes < 0)
+            throw std::runtime_error("DrawingStore: could not write the data");
+        written += static_cast<size_t>(bytes);
+    }
+    const uint64_t offset = m_data_size;
+    m_data_size += record.size();
+    if (is_new_key && 2 * (get_number_of_entries() + 1) > get_capacity())
+        grow_index();
+    const size_t position = slot_position(find_slot(normalized_key));
+    write_word(m_index, position + sizeof(uint64_t), offset);
+    write_word(m_index, position + 2 * sizeof(uint64_t), record.size());
+    write_word(m_index, position, normalized_key);
+    if (is_new_key)
+        write_word(m_index, 3 * sizeof(uint64_t), get_number_of_entries() + 1);
+}
+
+size_t DrawingStore::size() const {
+    std::lock_guard lock(m_mutex);
+    return static_cast<size_t>(get_number_of_entries());
+}
@@ -1,40 +1,110 @@
 #include "orthogonal/equivalence_classes.hpp"
 
-#include <functional>
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <ranges>
 #include <stdexcept>
 
-bool EquivalenceClasses::has_class(int class_id) const {
-    return m_class_to_elems.contains(class_id);
+int EquivalenceClasses::make_class() {
+    if (!m_free_classes.empty()) {
+        const int class_id = m_free_classes.back();
+        m_free_classes.pop_back();
+        return class_id;
+    }
+    m_class_to_elems.emplace_back();
+    return static_cast<int>(m_class_to_elems.size()) - 1;
 }
 
-void EquivalenceClasses::set_class(int elem, int class_id) {
-    if (has_elem_a_class(elem))
-        throw std::runtime_error(
-            "EquivalenceClasses::set_class elem already has an assigned class");
-    m_elem_to_class[elem] = class_id;
-    m_class_to_elems[class_id].insert(elem);
+void EquivalenceClasses::detach_elem(const size_t elem_index) {
+    const int class_id = m_elem_to_class[elem_index];
+    std::vector<int>& elems = m_class_to_elems[static_cast<size_t>(class_id)];
+    const size_t position = m_elem_position[elem_index];
+    const int last_elem = elems.back();
+    elems[position] = last_elem;
+    m_elem_position[m_elem_index.get_index(last_elem)] = position;
+    elems.pop_back();
+    if (elems.empty())
+        m_free_classes.push_back(class_id);
 }
 
-bool EquivalenceClasses::has_elem_a_class(int elem) const { return m_elem_to_class.contains(elem); }
+int EquivalenceClasses::add_elems(const std::span<const int> elems) {
+    const int class_id = make_class();
+    std::vector<int>& class_elems = m_class_to_elems[static_cast<size_t>(class_id)];
+    for (const int elem : elems) {
+        if (has_elem_a_class(elem))
+            throw std::runtime_error(
+                "EquivalenceClasses::add_elems elem already has an assigned class");
+        m_elem_index.add_node(elem);
+        m_elem_to_class.push_back(class_id);
+        m_elem_position.push_back(class_elems.size());
+        class_elems.push_back(elem);
+    }
+    return class_id;
+}
+
+bool EquivalenceClasses::has_elem_a_class(const int elem) const {
+    return m_elem_index.has_node(elem);
+}
 
-int EquivalenceClasses::get_class_of_elem(int elem) const {
+int EquivalenceClasses::get_class_of_elem(const int elem) const {
     if (!has_elem_a_class(elem))
         throw std::runtime_error("EquivalenceClasses::get_class elem does not have a class");
-    return m_elem_to_class.at(elem);
+    return m_elem_to_class[m_elem_index.get_index(elem)];
 }
 
-const std::unordered_set<int>& EquivalenceClasses::get_elems_of_class(int class_id) const {
+bool EquivalenceClasses::has_class(const int class_id) const {
+    return class_id >= 0 && static_cast<size_t>(class_id) < m_class_to_elems.size() &&
+           !m_class_to_elems[static_cast<size_t>(class_id)].empty();
+}
+
+const std::vector<int>& EquivalenceClasses::get_elems_of_class(const int class_id) const {
     if (!has_class(class_id))
         throw std::runtime_error("EquivalenceClasses::get_elems class does not exist");
-    return m_class_to_elems.at(class_id);
+    return m_class_to_elems[static_cast<size_t>(class_id)];
+}
+
+void EquivalenceClasses::move_elems(const std::span<const int> elems, const int class_id) {
+    if (!has_class(class_id))
+        throw std::runtime_error("EquivalenceClasses::move_elems class does not exist");
+    std::vector<int>& class_elems = m_class_to_elems[static_cast<size_t>(class_id)];
+    for (const int elem : elems) {
+        const size_t elem_index = m_elem_index.get_index(elem);
+        if (m_elem_to_class[elem_index] == class_id)
+            continue;
+        detach_elem(elem_index);
+        m_elem_to_class[elem_index] = class_id;
+        m_elem_position[elem_index] = class_elems.size();
+        class_elems.push_back(elem);
+    }
+}
+
+int EquivalenceClasses::move_elems_to_new_class(const std::span<const int> elems) {
+    const int class_id = make_class();
+    for (const int elem : elems) {
+        const size_t elem_index = m_elem_index.get_index(elem);
+        detach_elem(elem_index);
+        std::vector<int>& class_elems = m_class_to_elems[static_cast<size_t>(class_id)];
+        m_elem_to_class[elem_index] = class_id;
+        m_elem_position[elem_index] = class_elems.size();
+        class_elems.push_back(elem);
+    }
+    return class_id;
+}
+
+std::vector<int> EquivalenceClasses::get_all_classes() const {
+    std::vector<int> classes;
+    for (size_t class_id = 0; class_id < m_class_to_elems.size(); ++class_id)
+        if (!m_class_to_elems[class_id].empty())
+            classes.push_back(static_cast<int>(class_id));
+    return classes;
 }
 
 std::string EquivalenceClasses::to_string() const {
     std::string result = "EquivalenceClasses:\n";
-    for (const auto& [fst, snd] : m_class_to_elems) {
-        result += "Class " + std::to_string(fst) + ": ";
-        for (const int elem : snd)
+    for (const int class_id : get_all_classes()) {
+        result += "Class " + std::to_string(class_id) + ": ";
+        for (const int elem : get_elems_of_class(class_id))
             result += std::to_string(elem) + " ";
         result += "\n";
     }
@@ -43,130 +113,326 @@ std::string EquivalenceClasses::to_string() const {
 
 void EquivalenceClasses::print() const { std::cout << to_string() << std::endl; }
 
-void directional_node_expander(
-    const Shape& shape,
-    const UndirectedSimpleGraph& graph,
-    const GraphNode& node,
-    const int class_id,
-    EquivalenceClasses& equivalence_classes,
-    const std::function<bool(const Shape&, int, int)>& is_direction_wrong) {
-    const int node_id = node.get_id();
-    equivalence_classes.set_class(node_id, class_id);
-    for (auto& edge : node.get_edges()) {
-        const int neighbor_id = edge.get_to_id();
-        const GraphNode& neighbor = graph.get_node_by_id(neighbor_id);
-        if (equivalence_classes.has_elem_a_class(neighbor_id))
-            continue;
-        if (is_direction_wrong(shape, node_id, neighbor_id))
+// edges keeping the coordinate of the axis join nodes of the same class
+bool is_class_edge(const Axis axis, const Direction direction) {
+    if (axis == Axis::X)
+        return direction == Direction::UP || direction == Direction::DOWN;
+    return direction == Direction::LEFT || direction == Direction::RIGHT;
+}
+
+bool is_forward_edge(const Axis axis, const Direction direction) {
+    return direction == (axis == Axis::X ? Direction::RIGHT : Direction::UP);
+}
+
+constexpr std::array<Axis, 2> AXES = {Axis::X, Axis::Y};
+
+ShapeOrderings::ShapeOrderings(const UndirectedSimpleGraph& graph, const Shape& shape) {
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    m_nodes_index.reserve(nodes_ids.size());
+    for (const int node_id : nodes_ids) {
+        m_nodes_index.add_node(node_id);
+        m_neighbors.emplace_back();
+        m_is_moving.push_back(false);
+    }
+    for (const int node_id : nodes_ids)
+        for (const GraphNeighbor neighbor : graph.get_neighbors(node_id))
+            get_neighbors(node_id).emplace_back(neighbor.id,
+                                                shape.get_direction(node_id, neighbor.id));
+    for (const Axis axis : AXES)
+        build_axis(axis);
+}
+
+std::vector<std::pair<int, Direction>>& ShapeOrderings::get_neighbors(const int node_id) {
+    return m_neighbors[m_nodes_index.get_index(node_id)];
+}
+
+const std::vector<std::pair<int, Direction>>&
+ShapeOrderings::get_neighbors(const int node_id) const {
+    return m_neighbors[m_nodes_index.get_index(node_id)];
+}
+
+// nodes reachable from node_id through class edges, in breadth first order
+std::vector<int> ShapeOrderings::collect_class_component(const Axis axis, const int node_id) {
+    std::vector<int> component{node_id};
+    m_is_moving[m_nodes_index.get_index(node_id)] = true;
+    for (size_t head = 0; head < component.size(); ++head) {
+        for (const auto& [neighbor_id, direction] : get_neighbors(component[head])) {
+            const size_t neighbor_index = m_nodes_index.get_index(neighbor_id);
+            if (!is_class_edge(axis, direction) || m_is_moving[neighbor_index])
+                continue;
+            m_is_moving[neighbor_index] = true;
+            component.push_back(neighbor_id);
+        }
+    }
+    for (const int id : component)
+        m_is_moving[m_nodes_index.get_index(id)] = false;
+    return component;
+}
+
+void ShapeOrderings::build_axis(const Axis axis) {
+    AxisOrdering& axis_ordering = get_axis(axis);
+    for (const int node_id : m_nodes_index.get_nodes_ids()) {
+        if (axis_ordering.classes.has_elem_a_class(node_id))
             continue;
-        directional_node_expander(shape,
-                                  graph,
-                                  neighbor,
-                                  class_id,
-                                  equivalence_classes,
-                                  is_direction_wrong);
-    }
-}
-
-void horizontal_node_expander(const Shape& shape,
-                              const UndirectedSimpleGraph& graph,
-                              const GraphNode& node,
-                              const int class_id,
-                              EquivalenceClasses& equivalence_classes) {
-    auto is_direction_wrong = [](const Shape& s, int i, int j) { return s.is_vertical(i, j); };
-    directional_node_expander(shape,
-                              graph,
-                              node,
-                              class_id,
-                              equivalence_classes,
-                              is_direction_wrong);
-}
-
-void vertical_node_expander(const Shape& shape,
-                            const UndirectedSimpleGraph& graph,
-                            const GraphNode& node,
-                            const int class_id,
-                            EquivalenceClasses& equivalence_classes) {
-    auto is_direction_wrong = [](const Shape& s, int i, int j) { return s.is_horizontal(i, j); };
-    directional_node_expander(shape,
-                              graph,
-                              node,
-                              class_id,
-                              equivalence_classes,
-                              is_direction_wrong);
-}
-
-std::pair<const EquivalenceClasses, const EquivalenceClasses>
-build_equivalence_classes(const Shape& shape, const UndirectedSimpleGraph& graph) {
-    EquivalenceClasses equivalence_classes_x;
-    EquivalenceClasses equivalence_classes_y;
-    int next_class_x = 0;
-    int next_class_y = 0;
-    const std::vector<const GraphNode*> nodes = graph.get_nodes();
-    for (const GraphNode* node_ptr : nodes) {
-        const GraphNode& node = *node_ptr;
-        if (!equivalence_classes_y.has_elem_a_class(node.get_id()))
-            horizontal_node_expander(shape, graph, node, next_class_y++, equivalence_classes_y);
-        if (!equivalence_classes_x.has_elem_a_class(node.get_id()))
-            vertical_node_expander(shape, graph, node, next_class_x++, equivalence_classes_x);
-    }
-    for (const GraphNode* node_ptr : nodes) {
-        const GraphNode& node = *node_ptr;
-        if (!equivalence_classes_x.has_elem_a_class(node.get_id()))
-            equivalence_classes_x.set_class(node.get_id(), next_class_x++);
-        if (!equivalence_classes_y.has_elem_a_class(node.get_id()))
-            equivalence_classes_y.set_class(node.get_id(), next_class_y++);
-    }
-    return std::make_pair(std::move(equivalence_classes_x), std::move(equivalence_classes_y));
-}
-
-std::tuple<std::unique_ptr<DirectedSimpleGraph>,
-           std::unique_ptr<DirectedSimpleGraph>,
-           GraphAttributes,
-           GraphAttributes>
-equivalence_classes_to_ordering(const EquivalenceClasses& equivalence_classes_x,
-                                const EquivalenceClasses& equivalence_classes_y,
-                                const UndirectedSimpleGraph& graph,
-                                const Shape& shape) {
-    auto ordering_x = std::make_unique<DirectedSimpleGraph>();
-    auto ordering_y = std::make_unique<DirectedSimpleGraph>();
-    for (const int class_id : equivalence_classes_x.get_all_classes())
-        ordering_x->add_node(class_id);
-    for (const int class_id : equivalence_classes_y.get_all_classes())
-        ordering_y->add_node(class_id);
-    GraphAttributes ordering_x_edge_to_graph_edge;
-    GraphAttributes ordering_y_edge_to_graph_edge;
-    ordering_x_edge_to_graph_edge.add_attribute(Attribute::EDGES_ANY_LABEL);
-    ordering_y_edge_to_graph_edge.add_attribute(Attribute::EDGES_ANY_LABEL);
-    for (const GraphNode* node : graph.get_nodes()) {
-        const int node_id = node->get_id();
-        for (const GraphEdge& edge : node->get_edges()) {
-            const int neighbor_id = edge.get_to_id();
-            if (shape.is_right(node_id, neighbor_id)) {
-                const int node_class_x = equivalence_classes_x.get_class_of_elem(node_id);
-                const int neighbor_class_x = equivalence_classes_x.get_class_of_elem(neighbor_id);
-                if (ordering_x->has_edge(node_class_x, neighbor_class_x))
-                    continue;
-                ordering_x->add_edge(node_class_x, neighbor_class_x);
-                const GraphEdge& e = ordering_x->get_edge(node_class_x, neighbor_class_x);
-                ordering_x_edge_to_graph_edge.set_edge_any_label(
-                    e.get_id(),
-                    std::make_pair(node_id, neighbor_id));
-            } else if (shape.is_up(node_id, neighbor_id)) {
-                const int node_class_y = equivalence_classes_y.get_class_of_elem(node_id);
-                const int neighbor_class_y = equivalence_classes_y.get_class_of_elem(neighbor_id);
-                if (ordering_y->has_edge(node_class_y, neighbor_class_y))
+        const std::vector<int> component = collect_class_component(axis, node_id);
+        axis_ordering.ordering.add_node(axis_ordering.classes.add_elems(component));
+    }
+    for (const int node_id : m_nodes_index.get_nodes_ids())
+        for (const auto& [neighbor_id, direction] : get_neighbors(node_id))
+            if (is_forward_edge(axis, direction))
+                add_ordering_edge(axis, node_id, neighbor_id, direction);
+}
+
+// the edge (from_id, to_id) must not be a class edge
+void ShapeOrderings::add_ordering_edge(const Axis axis,
+                                       int from_id,
+                                       int to_id,
+                                       const Direction direction) {
+    AxisOrdering& axis_ordering = get_axis(axis);
+    if (!is_forward_edge(axis, direction))
+        std::swap(from_id, to_id);
+    const int from_class = axis_ordering.classes.get_class_of_elem(from_id);
+    const int to_class = axis_ordering.classes.get_class_of_elem(to_id);
+    if (axis_ordering.multiplicity[{from_class, to_class}]++ == 0)
+        axis_ordering.ordering.add_edge(from_class, to_class);
+}
+
+void ShapeOrderings::remove_ordering_edge(const Axis axis,
+                                          int from_id,
+                                          int to_id,
+                                          const Direction direction) {
+    AxisOrdering& axis_ordering = get_axis(axis);
+    if (!is_forward_edge(axis, direction))
+        std::swap(from_id, to_id);
+    const int from_class = axis_ordering.classes.get_class_of_elem(from_id);
+    const int to_class = axis_ordering.classes.get_class_of_elem(to_id);
+    const auto it = axis_ordering.multiplicity.find({from_class, to_class});
+    if (it == axis_ordering.multiplicity.end())
+        throw std::runtime_error("ShapeOrderings::remove_ordering_edge: edge not found");
+    if (--it->second > 0)
+        return;
+    axis_ordering.multiplicity.erase(it);
+    axis_ordering.ordering.remove_edge(from_class, to_class);
+}
+
+// adds (or removes) the ordering edges incident to the given nodes, which must be marked as
+// moving, counting once the edges between two of them
+void ShapeOrderings::change_ordering_edges(const Axis axis,
+                                           const std::span<const int> nodes_ids,
+                                           const bool add) {
+    for (const int node_id : nodes_ids) {
+        for (const auto& [neighbor_id, direction] : get_neighbors(node_id)) {
+            if (is_class_edge(axis, direction))
+                continue;
+            if (m_is_moving[m_nodes_index.get_index(neighbor_id)] && neighbor_id < node_id)
+                continue;
+            if (add)
+                add_ordering_edge(axis, node_id, neighbor_id, direction);
+            else
+                remove_ordering_edge(axis, node_id, neighbor_id, direction);
+        }
+    }
+}
+
+// moves the nodes (all from the same class) in the given class, or in a new one, the ordering
+// edges incident to them are re-attached to their new class
+void ShapeOrderings::move_nodes(const Axis axis,
+                                const std::span<const int> nodes_ids,
+                                const std::optional<int> class_id) {
+    AxisOrdering& axis_ordering = get_axis(axis);
+    for (const int node_id : nodes_ids)
+        m_is_moving[m_nodes_index.get_index(node_id)] = true;
+    change_ordering_edges(axis, nodes_ids, false);
+    const int old_class_id = axis_ordering.classes.get_class_of_elem(nodes_ids.front());
+    if (class_id.has_value()) {
+        axis_ordering.classes.move_elems(nodes_ids, *class_id);
+    } else {
+        const int new_class_id = axis_ordering.classes.move_elems_to_new_class(nodes_ids);
+        axis_ordering.ordering.add_node(new_class_id);
+    }
+    if (!axis_ordering.classes.has_class(old_class_id))
+        axis_ordering.ordering.remove_node(old_class_id);
+    change_ordering_edges(axis, nodes_ids, true);
+    for (const int node_id : nodes_ids)
+        m_is_moving[m_nodes_index.get_index(node_id)] = false;
+}
+
+void ShapeOrderings::join_classes(const Axis axis, const int node_id_1, const int node_id_2) {
+    const EquivalenceClasses& classes = get_axis(axis).classes;
+    int class_1 = classes.get_class_of_elem(node_id_1);
+    int class_2 = classes.get_class_of_elem(node_id_2);
+    if (class_1 == class_2)
+        return;
+    // the smaller class moves into the bigger one
+    if (classes.get_elems_of_class(class_1).size() > classes.get_elems_of_class(class_2).size())
+        std::swap(class_1, class_2);
+    const std::vector<int> moving_nodes = classes.get_elems_of_class(class_1);
+    move_nodes(axis, moving_nodes, class_2);
+}
+
+// to be called once a class edge between the two nodes has been removed
+void ShapeOrderings::split_class(const Axis axis, const int node_id_1, const int node_id_2) {
+    const std::vector<int> component = collect_class_component(axis, node_id_1);
+    if (std::ranges::find(component, node_id_2) != component.end())
+        return;
+    move_nodes(axis, component, std::nullopt);
+}
+
+void ShapeOrderings::add_node(const int node_id) {
+    invalidate_classes_forests();
+    m_nodes_index.add_node(node_id);
+    m_neighbors.emplace_back();
+    m_is_moving.push_back(false);
+    const std::array<int, 1> elems{node_id};
+    for (const Axis axis : AXES) {
+        AxisOrdering& axis_ordering = get_axis(axis);
+        axis_ordering.ordering.add_node(axis_ordering.classes.add_elems(elems));
+    }
+}
+
+void ShapeOrderings::add_edge(const int from_id, const int to_id, const Direction direction) {
+    invalidate_classes_forests();
+    get_neighbors(from_id).emplace_back(to_id, direction);
+    get_neighbors(to_id).emplace_back(from_id, opposite_direction(direction));
+    for (const Axis axis : AXES) {
+        if (is_class_edge(axis, direction))
+            join_classes(axis, from_id, to_id);
+        else
+            add_ordering_edge(axis, from_id, to_id, direction);
+    }
+}
+
+void ShapeOrderings::remove_edge(const int from_id, const int to_id) {
+    std::vector<std::pair<int, Direction>>& from_neighbors = get_neighbors(from_id);
+    const auto it = std::ranges::find(from_neighbors, to_id, &std::pair<int, Direction>::first);
+    if (it == from_neighbors.end())
+        throw std::runtime_error("ShapeOrderings::remove_edge: edge not found");
+    invalidate_classes_forests();
+    const Direction direction = it->second;
+    // ordering edges are removed while both nodes are still in their classes
+    for (const Axis axis : AXES)
+        if (!is_class_edge(axis, direction))
+            remove_ordering_edge(axis, from_id, to_id, direction);
+    from_neighbors.erase(it);
+    std::erase_if(get_neighbors(to_id), [from_id](const auto& neighbor) {
+        return neighbor.first == from_id;
+    });
+    for (const Axis axis : AXES)
+        if (is_class_edge(axis, direction))
+            split_class(axis, from_id, to_id);
+}
+
+void ShapeOrderings::change_direction(const int from_id,
+                                      const int to_id,
+                                      const Direction direction) {
+    remove_edge(from_id, to_id);
+    add_edge(from_id, to_id, direction);
+}
+
+void ShapeOrderings::update(const UndirectedSimpleGraph& graph, const Shape& shape) {
+    for (const int node_id : graph.get_nodes_ids())
+        if (!m_nodes_index.has_node(node_id))
+            add_node(node_id);
+    if (m_nodes_index.size() != graph.size())
+        throw std::runtime_error("ShapeOrderings::update: nodes cannot be removed");
+    std::vector<std::pair<int, int>> removed_edges;
+    for (const int node_id : m_nodes_index.get_nodes_ids())
+        for (const int neighbor_id : get_neighbors(node_id) | std::views::keys)
+            if (node_id < neighbor_id && !graph.has_edge(node_id, neighbor_id))
+                removed_edges.emplace_back(node_id, neighbor_id);
+    for (const auto& [from_id, to_id] : removed_edges)
+        remove_edge(from_id, to_id);
+    for (const int node_id : graph.get_nodes_ids()) {
+        for (const GraphNeighbor neighbor : graph.get_neighbors(node_id)) {
+            if (node_id > neighbor.id)
+                continue;
+            const Direction direction = shape.get_direction(node_id, neighbor.id);
+            const std::vector<std::pair<int, Direction>>& neighbors = get_neighbors(node_id);
+            const auto it =
+                std::ranges::find(neighbors, neighbor.id, &std::pair<int, Direction>::first);
+            if (it == neighbors.end())
+                add_edge(node_id, neighbor.id, direction);
+            else if (it->second != direction)
+                change_direction(node_id, neighbor.id, direction);
+        }
+    }
+}
+
+void ShapeOrderings::invalidate_classes_forests() {
+    m_x.is_forest_valid = false;
+    m_y.is_forest_valid = false;
+}
+
+// breadth first trees of the classes, rooted in their first node
+void ShapeOrderings::build_classes_forest(const Axis axis) const {
+    const AxisOrdering& axis_ordering = get_axis(axis);
+    std::vector<size_t>& parent = axis_ordering.forest_parent;
+    std::vector<size_t>& depth = axis_ordering.forest_depth;
+    parent.assign(m_nodes_index.size(), NodeIndexMap::NO_INDEX);
+    depth.assign(m_nodes_index.size(), 0);
+    std::vector<size_t> queue;
+    for (const int class_id : axis_ordering.classes.get_all_classes()) {
+        const size_t root = m_nodes_index.get_index(
+            axis_ordering.classes.get_elems_of_class(class_id).front());
+        parent[root] = root;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const size_t node = queue[head];
+            for (const auto& [neighbor_id, direction] : m_neighbors[node]) {
+                const size_t neighbor = m_nodes_index.get_index(neighbor_id);
+                if (!is_class_edge(axis, direction) || parent[neighbor] != NodeIndexMap::NO_INDEX)
                     continue;
-                ordering_y->add_edge(node_class_y, neighbor_class_y);
-                const GraphEdge& e = ordering_y->get_edge(node_class_y, neighbor_class_y);
-                ordering_y_edge_to_graph_edge.set_edge_any_label(
-                    e.get_id(),
-                    std::make_pair(node_id, neighbor_id));
+                parent[neighbor] = node;
+                depth[neighbor] = depth[node] + 1;
+                queue.push_back(neighbor);
             }
         }
     }
-    return std::make_tuple(std::move(ordering_x),
-                           std::move(ordering_y),
-                           std::move(ordering_x_edge_to_graph_edge),
-                           std::move(ordering_y_edge_to_graph_edge));
-}
\ No newline at end of file
+    axis_ordering.is_forest_valid = true;
+}
+
+std::vector<int>
+ShapeOrderings::get_path_in_class(const Axis axis, const int from_id, const int to_id) const {
+    const AxisOrdering& axis_ordering = get_axis(axis);
+    if (axis_ordering.classes.get_class_of_elem(from_id) !=
+        axis_ordering.classes.get_class_of_elem(to_id))
+        throw std::runtime_error("ShapeOrderings::get_path_in_class: nodes in different classes");
+    if (!axis_ordering.is_forest_valid)
+        build_classes_forest(axis);
+    const std::vector<size_t>& parent = axis_ordering.forest_parent;
+    const std::vector<size_t>& depth = axis_ordering.forest_depth;
+    // both ends climb up to their lowest common ancestor
+    size_t from = m_nodes_index.get_index(from_id);
+    size_t to = m_nodes_index.get_index(to_id);
+    std::vector<int> path;
+    std::vector<int> path_back;
+    while (depth[from] > depth[to]) {
+        path.push_back(m_nodes_index.get_node_id(from));
+        from = parent[from];
+    }
+    while (depth[to] > depth[from]) {
+        path_back.push_back(m_nodes_index.get_node_id(to));
+        to = parent[to];
+    }
+    while (from != to) {
+        path.push_back(m_nodes_index.get_node_id(from));
+        path_back.push_back(m_nodes_index.get_node_id(to));
+        from = parent[from];
+        to = parent[to];
+    }
+    path.push_back(m_nodes_index.get_node_id(from));
+    path.insert(path.end(), path_back.rbegin(), path_back.rend());
+    return path;
+}
+
+std::pair<int, int> ShapeOrderings::get_ordering_edge_witness(const Axis axis,
+                                                              const int from_class,
+                                                              const int to_class) const {
+    const EquivalenceClasses& classes = get_axis(axis).classes;
+    for (const int node_id : classes.get_elems_of_class(from_class))
+        for (const auto& [neighbor_id, direction] : get_neighbors(node_id))
+            if (is_forward_edge(axis, direction) &&
+                classes.get_class_of_elem(neighbor_id) == to_class)
+                return {node_id, neighbor_id};
+    throw std::runtime_error("ShapeOrderings::get_ordering_edge_witness: edge not found");
+}
@@ -1,9 +1,13 @@
 #include "orthogonal/file_loader.hpp"
 
+#include <array>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 
+#include "core/mapped_file.hpp"
+
 Shape load_shape_from_file(const std::string& filename) {
     std::ifstream infile(filename);
     if (infile.is_open()) {
@@ -40,4 +44,172 @@ void save_shape_to_file(const DirectedSimpleGraph& graph,
         outfile.close();
     } else
         throw std::runtime_error("Unable to save shape: " + filename);
-}
\ No newline at end of file
+}
+
+constexpr std::array<char, 8> DRAWING_MAGIC = {'D', 'O', 'M', 'U', 'S', 'D', 'R', 'W'};
+constexpr uint32_t DRAWING_VERSION = 1;
+// magic, version, a reserved word, then the numbers of nodes and edges and the three counters
+constexpr size_t DRAWING_HEADER_SIZE = 8 + 2 * sizeof(uint32_t) + 5 * sizeof(uint64_t);
+constexpr size_t DRAWING_COUNTERS_OFFSET = 8 + 2 * sizeof(uint32_t);
+
+template <typename T> void append_value(std::string& bytes, const T value) {
+    std::array<char, sizeof(T)> value_bytes;
+    std::memcpy(value_bytes.data(), &value, sizeof(T));
+    bytes.append(value_bytes.data(), sizeof(T));
+}
+
+size_t align_to_int(const size_t offset) {
+    return (offset + sizeof(int32_t) - 1) / sizeof(int32_t) * sizeof(int32_t);
+}
+
+std::string drawing_result_to_binary(const DrawingResult& result) {
+    const UndirectedSimpleGraph& graph = *result.augmented_graph;
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    const std::vector<GraphEdge> edges = graph.get_edges();
+    std::string bytes(DRAWING_MAGIC.data(), DRAWING_MAGIC.size());
+    append_value(bytes, DRAWING_VERSION);
+    append_value(bytes, static_cast<uint32_t>(0));
+    for (const size_t value : {nodes_ids.size(),
+                               edges.size(),
+                               result.initial_number_of_cycles,
+                               result.number_of_added_cycles,
+                               result.number_of_useless_bends})
+        append_value(bytes, static_cast<uint64_t>(value));
+    for (const int node_id : nodes_ids)
+        append_value(bytes, static_cast<int32_t>(node_id));
+    for (const int node_id : nodes_ids)
+        append_value(bytes, static_cast<int32_t>(result.attributes.get_position_x(node_id)));
+    for (const int node_id : nodes_ids)
+        append_value(bytes, static_cast<int32_t>(result.attributes.get_position_y(node_id)));
+    for (const int node_id : nodes_ids)
+        append_value(bytes, static_cast<uint8_t>(result.attributes.get_node_color(node_id)));
+    bytes.resize(align_to_int(bytes.size()), 0);
+    for (const GraphEdge& edge : edges) {
+        append_value(bytes, static_cast<int32_t>(edge.get_from_id()));
+        append_value(bytes, static_cast<int32_t>(edge.get_to_id()));
+    }
+    const size_t directions_offset = bytes.size();
+    bytes.resize(directions_offset + (edges.size() + 3) / 4, 0);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const auto direction = static_cast<unsigned>(
+            result.shape.get_direction(edges[i].get_from_id(), edges[i].get_to_id()));
+        const auto byte = static_cast<unsigned char>(bytes[directions_offset + i / 4]);
+        bytes[directions_offset + i / 4] =
+            static_cast<char>(byte | (direction << (2 * (i % 4))));
+    }
+    return bytes;
+}
+
+void save_drawing_result_to_binary_file(const DrawingResult& result, const std::string& filename) {
+    std::ofstream outfile(filename, std::ios::binary);
+    if (!outfile.is_open())
+        throw std::runtime_error("Unable to save drawing: " + filename);
+    const std::string bytes = drawing_result_to_binary(result);
+    outfile.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+DrawingResultView::DrawingResultView(const std::span<const char> bytes) : m_bytes(bytes) {
+    if (m_bytes.size() < DRAWING_HEADER_SIZE ||
+        std::memcmp(m_bytes.data(), DRAWING_MAGIC.data(), DRAWING_MAGIC.size()) != 0)
+        throw std::runtime_error("DrawingResultView: not a binary drawing");
+    uint32_t version;
+    std::memcpy(&version, m_bytes.data() + DRAWING_MAGIC.size(), sizeof(version));
+    if (version != DRAWING_VERSION)
+        throw std::runtime_error("DrawingResultView: unsupported version " +
+                                 std::to_string(version));
+    m_number_of_nodes = static_cast<size_t>(read_counter(0));
+    m_number_of_edges = static_cast<size_t>(read_counter(1));
+    if (m_number_of_nodes > m_bytes.size() || m_number_of_edges > m_bytes.size())
+        throw std::runtime_error("DrawingResultView: truncated drawing");
+    m_positions_x_offset = DRAWING_HEADER_SIZE + m_number_of_nodes * sizeof(int32_t);
+    m_positions_y_offset = m_positions_x_offset + m_number_of_nodes * sizeof(int32_t);
+    m_colors_offset = m_positions_y_offset + m_number_of_nodes * sizeof(int32_t);
+    m_edges_offset = align_to_int(m_colors_offset + m_number_of_nodes);
+    m_directions_offset = m_edges_offset + 2 * m_number_of_edges * sizeof(int32_t);
+    if (m_directions_offset + (m_number_of_edges + 3) / 4 != m_bytes.size())
+        throw std::runtime_error("DrawingResultView: truncated drawing");
+}
+
+int DrawingResultView::read_int(const size_t offset) const {
+    int32_t value;
+    std::memcpy(&value, m_bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+uint64_t DrawingResultView::read_counter(const size_t index) const {
+    uint64_t value;
+    std::memcpy(&value,
+                m_bytes.data() + DRAWING_COUNTERS_OFFSET + index * sizeof(uint64_t),
+                sizeof(value));
+    return value;
+}
+
+int DrawingResultView::get_node_id(const size_t index) const {
+    return read_int(DRAWING_HEADER_SIZE + index * sizeof(int32_t));
+}
+
+Color DrawingResultView::get_node_color(const size_t index) const {
+    return static_cast<Color>(static_cast<unsigned char>(m_bytes[m_colors_offset + index]));
+}
+
+int DrawingResultView::get_position_x(const size_t index) const {
+    return read_int(m_positions_x_offset + index * sizeof(int32_t));
+}
+
+int DrawingResultView::get_position_y(const size_t index) const {
+    return read_int(m_positions_y_offset + index * sizeof(int32_t));
+}
+
+std::pair<int, int> DrawingResultView::get_edge(const size_t index) const {
+    const size_t offset = m_edges_offset + 2 * index * sizeof(int32_t);
+    return {read_int(offset), read_int(offset + sizeof(int32_t))};
+}
+
+Direction DrawingResultView::get_direction(const size_t index) const {
+    const auto byte = static_cast<unsigned char>(m_bytes[m_directions_offset + index / 4]);
+    return static_cast<Direction>((byte >> (2 * (index % 4))) & 3u);
+}
+
+size_t DrawingResultView::get_initial_number_of_cycles() const {
+    return static_cast<size_t>(read_counter(2));
+}
+
+size_t DrawingResultView::get_number_of_added_cycles() const {
+    return static_cast<size_t>(read_counter(3));
+}
+
+size_t DrawingResultView::get_number_of_useless_bends() const {
+    return static_cast<size_t>(read_counter(4));
+}
+
+DrawingResult DrawingResultView::to_drawing_result() const {
+    auto graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphAttributes attributes;
+    attributes.add_attribute(Attribute::NODES_COLOR);
+    attributes.add_attribute(Attribute::NODES_POSITION);
+    for (size_t i = 0; i < m_number_of_nodes; ++i) {
+        const int node_id = get_node_id(i);
+        graph->add_node(node_id);
+        attributes.set_node_color(node_id, get_node_color(i));
+        attributes.set_position(node_id, get_position_x(i), get_position_y(i));
+    }
+    Shape shape;
+    for (size_t i = 0; i < m_number_of_edges; ++i) {
+        const auto [from_id, to_id] = get_edge(i);
+        const Direction direction = get_direction(i);
+        graph->add_edge(from_id, to_id);
+        shape.set_direction(from_id, to_id, direction);
+        shape.set_direction(to_id, from_id, opposite_direction(direction));
+    }
+    return {std::move(graph),
+            std::move(attributes),
+            std::move(shape),
+            get_initial_number_of_cycles(),
+            get_number_of_added_cycles(),
+            get_number_of_useless_bends()};
+}
+
+DrawingResult load_drawing_result_from_binary_file(const std::string& filename) {
+    const MappedFile file(filename);
+    return DrawingResultView(file.get_bytes()).to_drawing_result();
+}
@@ -1,16 +1,25 @@
 #include "orthogonal/shape/shape_builder.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
+#include <limits>
 #include <mutex>
+#include <numeric>
 #include <optional>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
-#include "orthogonal/shape/clauses_functions.hpp"
+#include "core/graph/graphs_algorithms.hpp"
+#include "orthogonal/shape/shape_encoder.hpp"
 #include "orthogonal/shape/variables_handler.hpp"
-#include "sat/cnf.hpp"
 #include "sat/kissat.hpp"
 
 const std::string unit_clauses_logs_file = "unit_clauses_logs.txt";
@@ -38,75 +47,213 @@ Shape result_to_shape(const UndirectedSimpleGraph& graph,
     return shape;
 }
 
-std::pair<int, int> find_edges_to_split(const std::vector<std::string>& proof_lines,
-                                        std::mt19937& random_engine,
-                                        const VariablesHandler& handler,
-                                        int number_of_variables) {
+// distinct edges of the unit clauses, in the same order
+std::vector<std::pair<int, int>> unit_clauses_edges(const std::vector<int>& unit_clauses,
+                                                    const size_t max_number_of_edges,
+                                                    const VariablesHandler& handler) {
+    std::vector<std::pair<int, int>> edges;
+    GraphEdgeHashSet seen_edges;
+    for (const int unit_clause : unit_clauses) {
+        if (edges.size() == max_number_of_edges)
+            break;
+        const auto [from_id, to_id] = handler.get_edge_of_variable(std::abs(unit_clause));
+        if (seen_edges.insert({std::min(from_id, to_id), std::max(from_id, to_id)}).second)
+            edges.emplace_back(from_id, to_id);
+    }
+    return edges;
+}
+
+std::vector<std::pair<int, int>> find_edges_to_split(const SatSolverResult& sat_result,
+                                                     const EdgeSplitOptions& split_options,
+                                                     std::mt19937& random_engine,
+                                                     const VariablesHandler& handler) {
+    // the last derived first
     std::vector<int> unit_clauses;
-    for (size_t i = proof_lines.size(); i > 0; i--) {
-        const std::string& line = proof_lines[i - 1];
-        // split line based on " "
-        std::vector<int> tokens;
-        std::string token;
-        for (char c : line) {
-            if (c == 'd')
-                continue;
-            if (c == ' ') {
-                if (token.empty())
-                    continue;
-                tokens.push_back(std::stoi(token));
-                token = "";
-            } else
-                token += c;
-        }
-        if (token != "0")
-            throw std::runtime_error("Invalid proof line");
-        if (tokens.size() == 1) {
-            int unit_clause = tokens[0];
-            if (std::abs(unit_clause) <= number_of_variables)
-                unit_clauses.push_back(unit_clause);
-        }
+    for (size_t i = sat_result.unit_clauses.size(); i > 0; i--) {
+        const int unit_clause = sat_result.unit_clauses[i - 1];
+        if (handler.has_variable(std::abs(unit_clause)))
+            unit_clauses.push_back(unit_clause);
     }
     if (unit_clauses.empty())
-        throw std::runtime_error("Could not find the edge to remove");
-    // pick one of the first two unit clauses
-    size_t random_index = random_engine() % std::min(unit_clauses.size(), static_cast<size_t>(2));
-    const int variable = std::abs(unit_clauses[random_index]);
+        return {};
+    std::vector<std::pair<int, int>> edges;
+    if (split_options.max_edges_per_round == 1) {
+        // pick one of the first two unit clauses
+        const size_t random_index =
+            random_engine() % std::min(unit_clauses.size(), static_cast<size_t>(2));
+        edges.push_back(handler.get_edge_of_variable(std::abs(unit_clauses[random_index])));
+    } else {
+        const size_t max_number_of_edges = split_options.max_edges_per_round == 0
+                                               ? std::numeric_limits<size_t>::max()
+                                               : split_options.max_edges_per_round;
+        edges = unit_clauses_edges(unit_clauses, max_number_of_edges, handler);
+    }
     std::lock_guard lock(unit_clauses_logs_mutex);
     std::ofstream log_file(unit_clauses_logs_file, std::ios_base::app);
     if (log_file) {
-        log_file << "units " << unit_clauses.size() << "\n";
+        log_file << "units " << sat_result.number_of_unit_clauses << "\n";
         log_file.close();
     } else {
         throw std::runtime_error("Error: Could not open log file for writing: " +
                                  unit_clauses_logs_file);
     }
-    return handler.get_edge_of_variable(variable);
+    return edges;
+}
+
+// the core minimization is bounded, every probe being a solve of its own
+constexpr size_t MAX_CORE_PROBES = 32;
+constexpr unsigned CORE_PROBE_CONFLICT_LIMIT = 2000;
+
+// true only if the problem is proven UNSAT when the clauses of the other edges are dropped
+bool is_core_unsat(const GuardedEdgesClauses& guarded,
+                   const std::vector<const Cnf*>& other_blocks,
+                   const std::vector<size_t>& enabled_edges,
+                   const SatSolverOptions& options) {
+    // kissat has no assumptions, so the enabled selectors are unit clauses of a fresh solver
+    Cnf assumptions;
+    for (const size_t index : enabled_edges)
+        assumptions.add_clause({guarded.selectors[index]});
+    std::vector<const Cnf*> blocks = other_blocks;
+    blocks.push_back(&guarded.clauses);
+    blocks.push_back(&assumptions);
+    return launch_kissat(blocks, options).result == SatSolverResultType::UNSAT;
+}
+
+// edges whose clauses are needed for the problem to be UNSAT: chunks of edges, halving in size,
+// are dropped as long as the remaining ones stay UNSAT (a probe running out of budget keeps
+// its chunk), so the core is minimal when the probes are not exhausted; all the probes together
+// take at most the time limit of a single solve, each one on a single solver with an equal share
+// of the time left
+std::vector<std::pair<int, int>> find_core_edges(const ShapeEncoder& encoder,
+                                                 const SatSolverOptions& sat_options) {
+    const GuardedEdgesClauses guarded = encoder.get_guarded_edges_clauses();
+    const std::vector<const Cnf*> other_blocks = encoder.get_nodes_and_cycles_cnf_blocks();
+    SatSolverOptions options = sat_options;
+    options.produce_proof = false;
+    options.portfolio_size = 1;
+    if (options.conflict_limit == 0 || options.conflict_limit > CORE_PROBE_CONFLICT_LIMIT)
+        options.conflict_limit = CORE_PROBE_CONFLICT_LIMIT;
+    const bool has_deadline = sat_options.time_limit.count() > 0;
+    const auto deadline = std::chrono::steady_clock::now() + sat_options.time_limit;
+    std::vector<size_t> core(guarded.edges.size());
+    std::iota(core.begin(), core.end(), 0);
+    size_t number_of_probes = 0;
+    for (size_t chunk = std::max(core.size() / 2, static_cast<size_t>(1));
+         number_of_probes < MAX_CORE_PROBES;
+         chunk /= 2) {
+        size_t start = 0;
+        while (start < core.size() && number_of_probes < MAX_CORE_PROBES) {
+            if (has_deadline) {
+                const auto time_left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now());
+                if (time_left.count() <= 0)
+                    break;
+                const auto probes_left =
+                    static_cast<std::chrono::milliseconds::rep>(MAX_CORE_PROBES - number_of_probes);
+                options.time_limit = std::max(time_left / probes_left, std::chrono::milliseconds{1});
+            }
+            const size_t end = std::min(start + chunk, core.size());
+            std::vector<size_t> candidate;
+            candidate.reserve(core.size() - (end - start));
+            for (size_t i = 0; i < core.size(); ++i)
+                if (i < start || i >= end)
+                    candidate.push_back(core[i]);
+            number_of_probes++;
+            if (is_core_unsat(guarded, other_blocks, candidate, options))
+                core = std::move(candidate);
+            else
+                start = end;
+        }
+        if (chunk == 1 || (has_deadline && std::chrono::steady_clock::now() >= deadline))
+            break;
+    }
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(core.size());
+    for (const size_t index : core)
+        edges.push_back(guarded.edges[index]);
+    return edges;
+}
+
+std::vector<std::pair<int, int>> find_core_edges_to_split(const ShapeEncoder& encoder,
+                                                          const SatSolverOptions& sat_options,
+                                                          const EdgeSplitOptions& split_options,
+                                                          std::mt19937& random_engine) {
+    std::vector<std::pair<int, int>> edges = find_core_edges(encoder, sat_options);
+    if (edges.empty())
+        return edges;
+    if (split_options.max_edges_per_round == 1)
+        return {edges[random_engine() % edges.size()]};
+    std::ranges::shuffle(edges, random_engine);
+    if (split_options.max_edges_per_round != 0 && edges.size() > split_options.max_edges_per_round)
+        edges.resize(split_options.max_edges_per_round);
+    return edges;
+}
+
+// used when the solver runs out of budget (or its proof has no unit clauses): a corner on the
+// longest cycle relaxes its constraints the most, and it is cheap to find
+std::pair<int, int> find_fallback_edge_to_split(const UndirectedSimpleGraph& graph,
+                                                const std::vector<Cycle>& cycles,
+                                                std::mt19937& random_engine) {
+    const Cycle* longest_cycle = nullptr;
+    for (const Cycle& cycle : cycles)
+        if (longest_cycle == nullptr || cycle.size() > longest_cycle->size())
+            longest_cycle = &cycle;
+    if (longest_cycle != nullptr && !longest_cycle->empty()) {
+        const size_t index = random_engine() % longest_cycle->size();
+        const int node_id = longest_cycle->at(index);
+        return {node_id, longest_cycle->next_of_node(node_id)};
+    }
+    const std::vector<GraphEdge> edges = graph.get_edges();
+    if (edges.empty())
+        throw std::runtime_error("Could not find the edge to remove");
+    const GraphEdge& edge = edges[random_engine() % edges.size()];
+    return {edge.get_from_id(), edge.get_to_id()};
+}
+
+// the budgets double after every exhausted solve, so that build_shape always terminates
+void double_budgets(SatSolverOptions& sat_options) {
+    const auto double_limit = [](const unsigned limit) {
+        constexpr unsigned max_limit = std::numeric_limits<unsigned>::max();
+        return limit > max_limit / 2 ? max_limit : 2 * limit;
+    };
+    sat_options.conflict_limit = double_limit(sat_options.conflict_limit);
+    sat_options.decision_limit = double_limit(sat_options.decision_limit);
+    sat_options.time_limit *= 2;
 }
 
 std::optional<Shape> build_shape_or_add_corner(UndirectedSimpleGraph& graph,
                                                GraphAttributes& attributes,
                                                std::vector<Cycle>& cycles,
+                                               ShapeEncoder& encoder,
+                                               SatSolverOptions& sat_options,
+                                               const EdgeSplitOptions& split_options,
                                                std::mt19937& random_engine);
 
 Shape build_shape(UndirectedSimpleGraph& graph,
                   GraphAttributes& attributes,
                   std::vector<Cycle>& cycles,
-                  const bool randomize) {
+                  const bool randomize,
+                  const SatSolverOptions& sat_options,
+                  const EdgeSplitOptions& split_options,
+                  ForbiddenDirections forbidden_directions) {
     const size_t seed = randomize ? std::random_device{}() : 42;
     std::mt19937 random_engine(seed);
-    std::optional<Shape> shape =
-        build_shape_or_add_corner(graph, attributes, cycles, random_engine);
+    ShapeEncoder encoder(graph, cycles, std::move(forbidden_directions));
+    SatSolverOptions options = sat_options;
+    if (split_options.selection == EdgeSplitSelection::MINIMIZED_CORE)
+        options.produce_proof = false;
+    std::optional<Shape> shape;
     while (!shape.has_value())
-        shape = build_shape_or_add_corner(graph, attributes, cycles, random_engine);
+        shape = build_shape_or_add_corner(
+            graph, attributes, cycles, encoder, options, split_options, random_engine);
     return std::move(shape.value());
 }
 
-void add_corner_inside_edge(const int from_id,
-                            const int to_id,
-                            UndirectedSimpleGraph& graph,
-                            GraphAttributes& attributes,
-                            std::vector<Cycle>& cycles) {
+int add_corner_inside_edge(const int from_id,
+                           const int to_id,
+                           UndirectedSimpleGraph& graph,
+                           GraphAttributes& attributes,
+                           std::vector<Cycle>& cycles) {
     if (!graph.has_edge(from_id, to_id))
         throw std::runtime_error("Error: The edge is not in the graph");
     const int new_node_id = graph.add_node().get_id();
@@ -114,16 +261,9 @@ void add_corner_inside_edge(const int from_id,
     graph.remove_edge(from_id, to_id);
     graph.add_edge(from_id, new_node_id);
     graph.add_edge(to_id, new_node_id);
-    for (Cycle& cycle : cycles) {
-        if (!cycle.has_node(from_id) || !cycle.has_node(to_id))
-            continue;
-        const size_t from_pos = cycle.node_position(from_id);
-        const size_t to_pos = cycle.node_position(to_id);
-        if (cycle.next_of_node(from_id) == to_id)
-            cycle.insert(to_pos, new_node_id);
-        else if (cycle.next_of_node(to_id) == from_id)
-            cycle.insert(from_pos, new_node_id);
-    }
+    for (Cycle& cycle : cycles)
+        cycle.add_in_between_if_exists(from_id, to_id, new_node_id);
+    return new_node_id;
 }
 
 #include <iostream>
@@ -131,21 +271,212 @@ void add_corner_inside_edge(const int from_id,
 std::optional<Shape> build_shape_or_add_corner(UndirectedSimpleGraph& graph,
                                                GraphAttributes& attributes,
                                                std::vector<Cycle>& cycles,
+                                               ShapeEncoder& encoder,
+                                               SatSolverOptions& sat_options,
+                                               const EdgeSplitOptions& split_options,
                                                std::mt19937& random_engine) {
-    VariablesHandler handler(graph);
-    Cnf cnf{};
-    // cnf.add_comment("constraints one direction per edge");
-    add_constraints_one_direction_per_edge(graph, cnf, handler);
-    // cnf.add_comment("constraints nodes");
-    add_nodes_constraints(graph, cnf, handler);
-    // cnf.add_comment("constraints cycles");
-    add_cycles_constraints(cnf, cycles, handler);
-    const auto [result, numbers, proof_lines] = launch_kissat(cnf);
-    if (result == SatSolverResultType::UNSAT) {
-        const auto [from_id, to_id] =
-            find_edges_to_split(proof_lines, random_engine, handler, cnf.get_number_of_variables());
-        add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+    VariablesHandler& handler = encoder.get_handler();
+    const SatSolverResult sat_result = launch_kissat(encoder.get_cnf_blocks(), sat_options);
+    if (sat_result.result != SatSolverResultType::SAT) {
+        std::vector<std::pair<int, int>> edges_to_split;
+        const bool is_unsat = sat_result.result == SatSolverResultType::UNSAT;
+        if (is_unsat && split_options.selection == EdgeSplitSelection::MINIMIZED_CORE)
+            edges_to_split =
+                find_core_edges_to_split(encoder, sat_options, split_options, random_engine);
+        else if (is_unsat)
+            edges_to_split = find_edges_to_split(sat_result, split_options, random_engine, handler);
+        if (edges_to_split.empty())
+            edges_to_split.push_back(find_fallback_edge_to_split(graph, cycles, random_engine));
+        // the corners that turn out to be useless are removed by remove_useless_bends
+        for (const auto& [from_id, to_id] : edges_to_split) {
+            const int new_node_id =
+                add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+            encoder.update_after_split(from_id, to_id, new_node_id);
+        }
+        if (sat_result.result == SatSolverResultType::UNKNOWN)
+            double_budgets(sat_options);
         return std::nullopt;
     }
-    return result_to_shape(graph, numbers, handler);
-}
\ No newline at end of file
+    return result_to_shape(graph, sat_result.numbers, handler);
+}
+
+// the ports of a cut vertex are split among its components, in clockwise order, each component
+// gets as many as its edges at the cut vertex, the last one also gets the unused ones
+constexpr std::array<Direction, 4> CLOCKWISE_DIRECTIONS = {
+    Direction::UP, Direction::RIGHT, Direction::DOWN, Direction::LEFT};
+
+// the shape problem restricted to one biconnected component, node ids are the ones of the whole
+// graph, except for the corners added while solving
+struct ComponentShapeProblem {
+    std::unordered_set<int> nodes_ids;
+    UndirectedSimpleGraph graph;
+    std::vector<Cycle> cycles;
+    ForbiddenDirections forbidden_directions;
+    Shape shape;
+};
+
+// nullopt if some cycle is not inside a single component, or some cut vertex has more than four
+// edges (its ports could not be split among its components)
+std::optional<std::vector<ComponentShapeProblem>>
+split_shape_problem(const UndirectedSimpleGraph& graph, const std::vector<Cycle>& cycles) {
+    const BiconnectedComponents components = compute_biconnected_components(graph);
+    for (const int cut_vertex_id : components.get_cutvertices())
+        if (graph.get_degree_of_node(cut_vertex_id) > 4)
+            return std::nullopt;
+    std::vector<ComponentShapeProblem> problems(components.get_components().size());
+    std::unordered_map<int, size_t> cut_vertex_next_port;
+    for (size_t i = 0; i < problems.size(); ++i) {
+        const UndirectedSimpleGraph& component = *components.get_components()[i];
+        ComponentShapeProblem& problem = problems[i];
+        for (const int node_id : component.get_nodes_ids()) {
+            problem.nodes_ids.insert(node_id);
+            problem.graph.add_node(node_id);
+        }
+        for (const GraphEdge& edge : component.get_edges())
+            problem.graph.add_edge(edge.get_from_id(), edge.get_to_id());
+        for (const int node_id : component.get_nodes_ids()) {
+            if (!components.get_cutvertices().contains(node_id))
+                continue;
+            size_t& next_port = cut_vertex_next_port[node_id];
+            const size_t first_port = next_port;
+            next_port += component.get_degree_of_node(node_id);
+            const bool is_last_component = next_port == graph.get_degree_of_node(node_id);
+            const size_t last_port = is_last_component ? CLOCKWISE_DIRECTIONS.size() : next_port;
+            std::vector<Direction>& forbidden = problem.forbidden_directions[node_id];
+            for (size_t port = 0; port < CLOCKWISE_DIRECTIONS.size(); ++port)
+                if (port < first_port || port >= last_port)
+                    forbidden.push_back(CLOCKWISE_DIRECTIONS[port]);
+        }
+    }
+    for (const Cycle& cycle : cycles) {
+        const auto is_in_problem = [&cycle](const ComponentShapeProblem& problem) {
+            return std::ranges::all_of(cycle, [&problem](const int node_id) {
+                return problem.graph.has_node(node_id);
+            });
+        };
+        const auto problem = std::ranges::find_if(problems, is_in_problem);
+        if (problem == problems.end())
+            return std::nullopt;
+        problem->cycles.push_back(cycle);
+    }
+    return problems;
+}
+
+void solve_shape_problems(std::vector<ComponentShapeProblem>& problems,
+                          const bool randomize,
+                          const SatSolverOptions& sat_options,
+                          const EdgeSplitOptions& split_options) {
+    const auto solve = [&](ComponentShapeProblem& problem) {
+        GraphAttributes attributes;
+        attributes.add_attribute(Attribute::NODES_COLOR);
+        problem.shape = build_shape(problem.graph,
+                                    attributes,
+                                    problem.cycles,
+                                    randomize,
+                                    sat_options,
+                                    split_options,
+                                    std::move(problem.forbidden_directions));
+    };
+#ifdef __EMSCRIPTEN__
+    for (ComponentShapeProblem& problem : problems)
+        solve(problem);
+#else
+    const size_t number_of_threads =
+        std::min(problems.size(), static_cast<size_t>(std::thread::hardware_concurrency()));
+    std::atomic<size_t> next_problem = 0;
+    std::vector<std::exception_ptr> errors(problems.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::max(number_of_threads, static_cast<size_t>(1)); ++i)
+        threads.emplace_back([&] {
+            for (size_t j = next_problem++; j < problems.size(); j = next_problem++) {
+                try {
+                    solve(problems[j]);
+                } catch (...) {
+                    errors[j] = std::current_exception();
+                }
+            }
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (const std::exception_ptr& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+#endif
+}
+
+// the corners added in the component, walking from the original node from_id through corner_id
+std::vector<int> walk_corners(const ComponentShapeProblem& problem,
+                              const int from_id,
+                              const int corner_id) {
+    std::vector<int> path = {from_id};
+    int previous_id = from_id;
+    int current_id = corner_id;
+    while (!problem.nodes_ids.contains(current_id)) {
+        path.push_back(current_id);
+        for (const GraphNeighbor neighbor : problem.graph.get_neighbors(current_id))
+            if (neighbor.id != previous_id) {
+                previous_id = current_id;
+                current_id = neighbor.id;
+                break;
+            }
+    }
+    path.push_back(current_id);
+    return path;
+}
+
+// the corners of the component are added in the same places in the whole graph (and in its
+// cycles), then the directions of the component are copied in the shape of the whole graph
+void merge_shape_problem(const ComponentShapeProblem& problem,
+                         UndirectedSimpleGraph& graph,
+                         GraphAttributes& attributes,
+                         std::vector<Cycle>& cycles,
+                         Shape& shape) {
+    std::unordered_map<int, int> corner_to_node;
+    const auto to_graph_id = [&corner_to_node](const int node_id) {
+        const auto it = corner_to_node.find(node_id);
+        return it == corner_to_node.end() ? node_id : it->second;
+    };
+    for (const int node_id : problem.graph.get_nodes_ids()) {
+        if (!problem.nodes_ids.contains(node_id))
+            continue;
+        for (const GraphNeighbor neighbor : problem.graph.get_neighbors(node_id)) {
+            if (problem.nodes_ids.contains(neighbor.id) || corner_to_node.contains(neighbor.id))
+                continue;
+            // path from node_id to the other end of the edge that got split
+            const std::vector<int> path = walk_corners(problem, node_id, neighbor.id);
+            const int to_id = path.back();
+            int previous_id = node_id;
+            for (size_t i = 1; i + 1 < path.size(); ++i) {
+                const int new_node_id =
+                    add_corner_inside_edge(previous_id, to_id, graph, attributes, cycles);
+                corner_to_node[path[i]] = new_node_id;
+                previous_id = new_node_id;
+            }
+        }
+    }
+    for (const int node_id : problem.graph.get_nodes_ids())
+        for (const GraphNeighbor neighbor : problem.graph.get_neighbors(node_id))
+            shape.set_direction(to_graph_id(node_id),
+                                to_graph_id(neighbor.id),
+                                problem.shape.get_direction(node_id, neighbor.id));
+}
+
+std::optional<Shape>
+build_shape_by_biconnected_components(UndirectedSimpleGraph& graph,
+                                      GraphAttributes& attributes,
+                                      std::vector<Cycle>& cycles,
+                                      const bool randomize,
+                                      const SatSolverOptions& sat_options,
+                                      const EdgeSplitOptions& split_options) {
+    std::optional<std::vector<ComponentShapeProblem>> problems =
+        split_shape_problem(graph, cycles);
+    if (!problems.has_value())
+        return std::nullopt;
+    if (problems->size() == 1)
+        return build_shape(graph, attributes, cycles, randomize, sat_options, split_options);
+    solve_shape_problems(*problems, randomize, sat_options, split_options);
+    Shape shape;
+    for (const ComponentShapeProblem& problem : *problems)
+        merge_shape_problem(problem, graph, attributes, cycles, shape);
+    return shape;
+}
@@ -0,0 +1,135 @@
+#include "orthogonal/shape/shape_encoder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "orthogonal/shape/clauses_functions.hpp"
+
+std::pair<int, int> edge_key(const int from_id, const int to_id) {
+    return from_id < to_id ? std::make_pair(from_id, to_id) : std::make_pair(to_id, from_id);
+}
+
+ShapeEncoder::ShapeEncoder(const UndirectedSimpleGraph& graph,
+                           const std::vector<Cycle>& cycles,
+                           ForbiddenDirections forbidden_directions)
+    : m_graph(graph), m_cycles(cycles), m_handler(graph),
+      m_forbidden_directions(std::move(forbidden_directions)) {
+    for (const GraphNode* node : graph.get_nodes()) {
+        const int node_id = node->get_id();
+        for (const GraphNeighbor neighbor : node->get_neighbors())
+            if (node_id < neighbor.id)
+                encode_edge(node_id, neighbor.id);
+    }
+    for (const GraphNode* node : graph.get_nodes())
+        encode_node(node->get_id());
+    m_cycles_clauses.resize(cycles.size());
+    for (size_t i = 0; i < cycles.size(); ++i)
+        encode_cycle(i);
+}
+
+void ShapeEncoder::encode_edge(const int from_id, const int to_id) {
+    const std::pair<int, int> key = edge_key(from_id, to_id);
+    size_t block;
+    if (m_free_edge_blocks.empty()) {
+        block = m_edges_clauses.size();
+        m_edges_clauses.emplace_back();
+    } else {
+        block = m_free_edge_blocks.back();
+        m_free_edge_blocks.pop_back();
+    }
+    m_edge_to_block[key] = block;
+    add_edge_constraints(m_edges_clauses[block], m_handler, key.first, key.second);
+}
+
+void ShapeEncoder::remove_edge(const int from_id, const int to_id) {
+    const std::pair<int, int> key = edge_key(from_id, to_id);
+    const auto it = m_edge_to_block.find(key);
+    if (it == m_edge_to_block.end())
+        throw std::runtime_error("ShapeEncoder::remove_edge: edge not encoded");
+    m_edges_clauses[it->second] = Cnf{};
+    m_free_edge_blocks.push_back(it->second);
+    m_edge_to_block.erase(it);
+    m_handler.remove_edge(key.first, key.second);
+}
+
+void ShapeEncoder::encode_node(const int node_id) {
+    const auto [it, is_new] = m_node_to_block.try_emplace(node_id, m_nodes_clauses.size());
+    if (is_new)
+        m_nodes_clauses.emplace_back();
+    else
+        m_nodes_clauses[it->second] = Cnf{};
+    Cnf& cnf = m_nodes_clauses[it->second];
+    const GraphNode& node = m_graph.get_node_by_id(node_id);
+    add_node_constraints(cnf, m_handler, node);
+    const auto forbidden = m_forbidden_directions.find(node_id);
+    if (forbidden == m_forbidden_directions.end())
+        return;
+    for (const GraphNeighbor neighbor : node.get_neighbors())
+        for (const Direction direction : forbidden->second)
+            cnf.add_clause({-m_handler.get_variable(node_id, neighbor.id, direction)});
+}
+
+void ShapeEncoder::encode_cycle(const size_t cycle_index) {
+    m_cycles_clauses[cycle_index] = Cnf{};
+    add_cycle_constraints(m_cycles_clauses[cycle_index], m_cycles[cycle_index], m_handler);
+}
+
+void ShapeEncoder::update_after_split(const int from_id, const int to_id, const int new_node_id) {
+    remove_edge(from_id, to_id);
+    m_handler.add_edge(from_id, new_node_id);
+    m_handler.add_edge(to_id, new_node_id);
+    encode_edge(from_id, new_node_id);
+    encode_edge(to_id, new_node_id);
+    encode_node(from_id);
+    encode_node(to_id);
+    encode_node(new_node_id);
+    for (size_t i = 0; i < m_cycles.size(); ++i)
+        if (m_cycles[i].has_node(new_node_id))
+            encode_cycle(i);
+}
+
+std::vector<const Cnf*> ShapeEncoder::get_cnf_blocks() const {
+    std::vector<const Cnf*> blocks;
+    blocks.reserve(m_edges_clauses.size() + m_nodes_clauses.size() + m_cycles_clauses.size());
+    for (const Cnf& cnf : m_edges_clauses)
+        blocks.push_back(&cnf);
+    for (const Cnf& cnf : m_nodes_clauses)
+        blocks.push_back(&cnf);
+    for (const Cnf& cnf : m_cycles_clauses)
+        blocks.push_back(&cnf);
+    return blocks;
+}
+
+std::vector<const Cnf*> ShapeEncoder::get_nodes_and_cycles_cnf_blocks() const {
+    std::vector<const Cnf*> blocks;
+    blocks.reserve(m_nodes_clauses.size() + m_cycles_clauses.size());
+    for (const Cnf& cnf : m_nodes_clauses)
+        blocks.push_back(&cnf);
+    for (const Cnf& cnf : m_cycles_clauses)
+        blocks.push_back(&cnf);
+    return blocks;
+}
+
+GuardedEdgesClauses ShapeEncoder::get_guarded_edges_clauses() const {
+    // edges in the order of their blocks, so that the selectors do not depend on hashing
+    std::vector<std::pair<size_t, std::pair<int, int>>> blocks_edges;
+    blocks_edges.reserve(m_edge_to_block.size());
+    for (const auto& [edge, block] : m_edge_to_block)
+        blocks_edges.emplace_back(block, edge);
+    std::ranges::sort(blocks_edges);
+    GuardedEdgesClauses guarded;
+    int selector = m_handler.get_number_of_variables();
+    for (const auto& [block, edge] : blocks_edges) {
+        guarded.edges.push_back(edge);
+        guarded.selectors.push_back(++selector);
+        for (const CnfRow& row : m_edges_clauses[block].get_rows()) {
+            if (row.m_type != CnfRowType::CLAUSE)
+                continue;
+            std::vector<int> clause = row.m_clause;
+            clause.push_back(-selector);
+            guarded.clauses.add_clause(std::move(clause));
+        }
+    }
+    return guarded;
+}
@@ -45,6 +45,38 @@ VariablesHandler::VariablesHandler(const UndirectedSimpleGraph& graph) {
     }
 }
 
+void VariablesHandler::add_edge(const int i, const int j) {
+    if (m_edge_up_variable.contains({i, j}))
+        throw std::runtime_error("VariablesHandler::add_edge: edge already has variables");
+    if (i < j)
+        add_edge_variables(i, j);
+    else
+        add_edge_variables(j, i);
+}
+
+void VariablesHandler::remove_edge(const int i, const int j) {
+    if (!m_edge_up_variable.contains({i, j}))
+        throw std::runtime_error("VariablesHandler::remove_edge: edge does not have variables");
+    for (const int variable : {get_up_variable(i, j),
+                               get_down_variable(i, j),
+                               get_left_variable(i, j),
+                               get_right_variable(i, j)}) {
+        variable_to_edge.erase(variable);
+        variable_to_direction.erase(variable);
+        variable_to_value.erase(variable);
+    }
+    for (const auto& edge : {std::make_pair(i, j), std::make_pair(j, i)}) {
+        m_edge_up_variable.erase(edge);
+        m_edge_down_variable.erase(edge);
+        m_edge_left_variable.erase(edge);
+        m_edge_right_variable.erase(edge);
+    }
+}
+
+bool VariablesHandler::has_variable(const int variable) const {
+    return variable_to_edge.contains(variable);
+}
+
 int VariablesHandler::get_up_variable(int i, int j) const { return m_edge_up_variable.at({i, j}); }
 
 int VariablesHandler::get_down_variable(int i, int j) const {
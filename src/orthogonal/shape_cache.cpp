@@ -0,0 +1,384 @@
+#include "orthogonal/shape_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+// unlike std::hash, stable across runs and platforms, since the hashes are saved to disk
+uint64_t mix_hash(const uint64_t hash, const uint64_t value) {
+    uint64_t mixed = hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+    mixed ^= mixed >> 31;
+    mixed *= 0xbf58476d1ce4e5b9ULL;
+    mixed ^= mixed >> 27;
+    return mixed;
+}
+
+// colors start from the degrees, then every node is recolored by its color and the sorted colors
+// of its neighbors until no color splits; colors are ranks of the sorted signatures, so they do
+// not depend on ids, which only break the ties left at the end
+CanonicalGraph make_canonical_graph(const UndirectedSimpleGraph& graph) {
+    const std::vector<int> nodes_ids = graph.get_nodes_ids();
+    const size_t number_of_nodes = nodes_ids.size();
+    std::unordered_map<int, size_t> id_to_index;
+    for (size_t i = 0; i < number_of_nodes; ++i)
+        id_to_index[nodes_ids[i]] = i;
+    std::vector<std::vector<size_t>> neighbors(number_of_nodes);
+    for (size_t i = 0; i < number_of_nodes; ++i)
+        for (const GraphNeighbor neighbor : graph.get_neighbors(nodes_ids[i]))
+            neighbors[i].push_back(id_to_index.at(neighbor.id));
+    std::vector<size_t> colors(number_of_nodes);
+    for (size_t i = 0; i < number_of_nodes; ++i)
+        colors[i] = neighbors[i].size();
+    std::vector<std::vector<size_t>> signatures(number_of_nodes);
+    size_t number_of_colors = 0;
+    while (true) {
+        for (size_t i = 0; i < number_of_nodes; ++i) {
+            std::vector<size_t>& signature = signatures[i];
+            signature.clear();
+            for (const size_t neighbor : neighbors[i])
+                signature.push_back(colors[neighbor]);
+            std::ranges::sort(signature);
+            signature.push_back(colors[i]);
+        }
+        std::vector<std::vector<size_t>> distinct_signatures = signatures;
+        std::ranges::sort(distinct_signatures);
+        const auto duplicates = std::ranges::unique(distinct_signatures);
+        distinct_signatures.erase(duplicates.begin(), duplicates.end());
+        for (size_t i = 0; i < number_of_nodes; ++i)
+            colors[i] = static_cast<size_t>(
+                std::ranges::lower_bound(distinct_signatures, signatures[i]) -
+                distinct_signatures.begin());
+        if (distinct_signatures.size() == number_of_colors)
+            break;
+        number_of_colors = distinct_signatures.size();
+    }
+    std::vector<size_t> order(number_of_nodes);
+    for (size_t i = 0; i < number_of_nodes; ++i)
+        order[i] = i;
+    std::ranges::sort(order, [&](const size_t a, const size_t b) {
+        return std::make_pair(colors[a], nodes_ids[a]) < std::make_pair(colors[b], nodes_ids[b]);
+    });
+    std::vector<size_t> position(number_of_nodes);
+    CanonicalGraph canonical;
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+        position[order[i]] = i;
+        canonical.nodes_ids.push_back(nodes_ids[order[i]]);
+    }
+    for (size_t i = 0; i < number_of_nodes; ++i)
+        for (const size_t neighbor : neighbors[i])
+            if (position[i] < position[neighbor])
+                canonical.edges.emplace_back(position[i], position[neighbor]);
+    std::ranges::sort(canonical.edges);
+    canonical.hash = mix_hash(0, number_of_nodes);
+    for (const auto& [from, to] : canonical.edges)
+        canonical.hash = mix_hash(mix_hash(canonical.hash, from), to);
+    return canonical;
+}
+
+// every option that can change the drawing
+uint64_t hash_drawing_options(const DrawingOptions& options) {
+    const SatSolverOptions& sat = options.sat_options;
+    uint64_t hash = 0;
+    for (const uint64_t value : {static_cast<uint64_t>(sat.produce_proof),
+                                 static_cast<uint64_t>(sat.binary_proof),
+                                 static_cast<uint64_t>(sat.max_unit_clauses),
+                                 static_cast<uint64_t>(sat.conflict_limit),
+                                 static_cast<uint64_t>(sat.decision_limit),
+                                 static_cast<uint64_t>(sat.time_limit.count()),
+                                 static_cast<uint64_t>(sat.portfolio_size),
+                                 static_cast<uint64_t>(options.split_options.selection),
+                                 static_cast<uint64_t>(options.split_options.max_edges_per_round),
+                                 static_cast<uint64_t>(options.split_biconnected_components),
+                                 static_cast<uint64_t>(options.max_cycles_per_round),
+                                 static_cast<uint64_t>(options.area_compaction)})
+        hash = mix_hash(hash, value);
+    return hash;
+}
+
+size_t CachedDrawing::get_size_in_bytes() const {
+    return sizeof(CachedDrawing) +
+           (edges.size() + augmented_edges.size()) * sizeof(std::pair<size_t, size_t>) +
+           colors.size() * sizeof(Color) +
+           (positions_x.size() + positions_y.size()) * sizeof(int) +
+           directions.size() * sizeof(Direction);
+}
+
+CachedDrawing make_cached_drawing(const CanonicalGraph& canonical,
+                                  const uint64_t options_hash,
+                                  const DrawingResult& result,
+                                  const double time) {
+    const UndirectedSimpleGraph& augmented_graph = *result.augmented_graph;
+    std::vector<int> ids = canonical.nodes_ids;
+    std::unordered_map<int, size_t> id_to_position;
+    for (size_t i = 0; i < ids.size(); ++i)
+        id_to_position[ids[i]] = i;
+    std::vector<int> added_ids;
+    for (const int node_id : augmented_graph.get_nodes_ids())
+        if (!id_to_position.contains(node_id))
+            added_ids.push_back(node_id);
+    std::ranges::sort(added_ids);
+    for (const int node_id : added_ids) {
+        id_to_position[node_id] = ids.size();
+        ids.push_back(node_id);
+    }
+    CachedDrawing drawing{canonical.hash,
+                          options_hash,
+                          canonical.nodes_ids.size(),
+                          canonical.edges,
+                          {},
+                          {},
+                          {},
+                          {},
+                          {},
+                          result.initial_number_of_cycles,
+                          result.number_of_added_cycles,
+                          result.number_of_useless_bends,
+                          time};
+    for (const int node_id : ids) {
+        drawing.colors.push_back(result.attributes.get_node_color(node_id));
+        drawing.positions_x.push_back(result.attributes.get_position_x(node_id));
+        drawing.positions_y.push_back(result.attributes.get_position_y(node_id));
+    }
+    for (const GraphEdge& edge : augmented_graph.get_edges()) {
+        const int from_id = edge.get_from_id();
+        const int to_id = edge.get_to_id();
+        drawing.augmented_edges.emplace_back(id_to_position.at(from_id), id_to_position.at(to_id));
+        drawing.directions.push_back(result.shape.get_direction(from_id, to_id));
+    }
+    return drawing;
+}
+
+// the nodes added while drawing get the ids following the largest id of the graph
+DrawingResult make_drawing_result(const CachedDrawing& drawing, const CanonicalGraph& canonical) {
+    std::vector<int> ids = canonical.nodes_ids;
+    int next_id = ids.empty() ? 0 : std::ranges::max(ids) + 1;
+    while (ids.size() < drawing.colors.size())
+        ids.push_back(next_id++);
+    auto augmented_graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphAttributes attributes;
+    attributes.add_attribute(Attribute::NODES_COLOR);
+    attributes.add_attribute(Attribute::NODES_POSITION);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        augmented_graph->add_node(ids[i]);
+        attributes.set_node_color(ids[i], drawing.colors[i]);
+        attributes.set_position(ids[i], drawing.positions_x[i], drawing.positions_y[i]);
+    }
+    Shape shape;
+    for (size_t i = 0; i < drawing.augmented_edges.size(); ++i) {
+        const int from_id = ids[drawing.augmented_edges[i].first];
+        const int to_id = ids[drawing.augmented_edges[i].second];
+        augmented_graph->add_edge(from_id, to_id);
+        shape.set_direction(from_id, to_id, drawing.directions[i]);
+        shape.set_direction(to_id, from_id, opposite_direction(drawing.directions[i]));
+    }
+    return {std::move(augmented_graph),
+            std::move(attributes),
+            std::move(shape),
+            drawing.initial_number_of_cycles,
+            drawing.number_of_added_cycles,
+            drawing.number_of_useless_bends};
+}
+
+ShapeCache::ShapeCache(const size_t max_bytes, std::string file_path)
+    : m_max_bytes(max_bytes), m_file_path(std::move(file_path)) {
+    if (!m_file_path.empty() && std::filesystem::exists(m_file_path))
+        load();
+}
+
+ShapeCache::Entries::iterator ShapeCache::find_entry(const CanonicalGraph& canonical,
+                                                     const uint64_t options_hash) {
+    const auto it = m_key_to_entries.find(canonical.hash);
+    if (it == m_key_to_entries.end())
+        return m_entries.end();
+    for (const Entries::iterator entry : it->second)
+        if (entry->options_hash == options_hash &&
+            entry->number_of_nodes == canonical.nodes_ids.size() &&
+            entry->edges == canonical.edges) {
+            m_entries.splice(m_entries.begin(), m_entries, entry);
+            return entry;
+        }
+    return m_entries.end();
+}
+
+void ShapeCache::add_entry(CachedDrawing drawing) {
+    const size_t size_in_bytes = drawing.get_size_in_bytes();
+    if (size_in_bytes > m_max_bytes)
+        return;
+    const uint64_t graph_hash = drawing.graph_hash;
+    m_entries.push_front(std::move(drawing));
+    m_key_to_entries[graph_hash].push_back(m_entries.begin());
+    m_size_in_bytes += size_in_bytes;
+    evict();
+}
+
+void ShapeCache::evict() {
+    while (m_size_in_bytes > m_max_bytes) {
+        const Entries::iterator entry = std::prev(m_entries.end());
+        std::vector<Entries::iterator>& same_key = m_key_to_entries.at(entry->graph_hash);
+        std::erase(same_key, entry);
+        if (same_key.empty())
+            m_key_to_entries.erase(entry->graph_hash);
+        m_size_in_bytes -= entry->get_size_in_bytes();
+        m_entries.erase(entry);
+    }
+}
+
+std::optional<StoredDrawing> ShapeCache::find_drawing(const CanonicalGraph& canonical,
+                                                      const uint64_t options_hash) {
+    std::lock_guard lock(m_mutex);
+    const Entries::iterator entry = find_entry(canonical, options_hash);
+    if (entry == m_entries.end()) {
+        m_number_of_misses++;
+        return std::nullopt;
+    }
+    m_number_of_hits++;
+    return StoredDrawing{make_drawing_result(*entry, canonical), entry->time};
+}
+
+void ShapeCache::insert_drawing(const CanonicalGraph& canonical,
+                                const uint64_t options_hash,
+                                const DrawingResult& result,
+                                const double time) {
+    CachedDrawing drawing = make_cached_drawing(canonical, options_hash, result, time);
+    std::lock_guard lock(m_mutex);
+    if (find_entry(canonical, options_hash) == m_entries.end())
+        add_entry(std::move(drawing));
+}
+
+// the drawing is computed outside the lock, so the same graph can be drawn twice at once
+StoredDrawing ShapeCache::make_orthogonal_drawing(const UndirectedSimpleGraph& graph,
+                                                  const DrawingOptions& options) {
+    const CanonicalGraph canonical = make_canonical_graph(graph);
+    const uint64_t options_hash = hash_drawing_options(options);
+    std::optional<StoredDrawing> cached = find_drawing(canonical, options_hash);
+    if (cached.has_value())
+        return std::move(*cached);
+    const auto start = std::chrono::steady_clock::now();
+    DrawingResult result = ::make_orthogonal_drawing(graph, options);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    insert_drawing(canonical, options_hash, result, elapsed.count());
+    return {std::move(result), elapsed.count()};
+}
+
+std::optional<StoredDrawing> ShapeCache::find(const UndirectedSimpleGraph& graph,
+                                              const DrawingOptions& options) {
+    return find_drawing(make_canonical_graph(graph), hash_drawing_options(options));
+}
+
+void ShapeCache::insert(const UndirectedSimpleGraph& graph,
+                        const DrawingOptions& options,
+                        const DrawingResult& result,
+                        const double time) {
+    insert_drawing(make_canonical_graph(graph), hash_drawing_options(options), result, time);
+}
+
+// one drawing per line, the least recently used first, so that loading them back (each becoming
+// the most recently used) keeps their order
+void ShapeCache::save() const {
+    if (m_file_path.empty())
+        throw std::runtime_error("ShapeCache::save: the cache has no file");
+    std::lock_guard lock(m_mutex);
+    std::ofstream file(m_file_path);
+    if (!file.is_open())
+        throw std::runtime_error("ShapeCache::save: could not open " + m_file_path);
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (auto entry = m_entries.rbegin(); entry != m_entries.rend(); ++entry) {
+        file << entry->graph_hash << " " << entry->options_hash << " "
+             << entry->number_of_nodes << " " << entry->edges.size();
+        for (const auto& [from, to] : entry->edges)
+            file << " " << from << " " << to;
+        file << " " << entry->colors.size();
+        for (size_t i = 0; i < entry->colors.size(); ++i)
+            file << " " << static_cast<int>(entry->colors[i]) << " " << entry->positions_x[i]
+                 << " " << entry->positions_y[i];
+        file << " " << entry->augmented_edges.size();
+        for (size_t i = 0; i < entry->augmented_edges.size(); ++i)
+            file << " " << entry->augmented_edges[i].first << " "
+                 << entry->augmented_edges[i].second << " "
+                 << static_cast<int>(entry->directions[i]);
+        file << " " << entry->initial_number_of_cycles << " " << entry->number_of_added_cycles
+             << " " << entry->number_of_useless_bends << " " << entry->time << "\n";
+    }
+}
+
+void ShapeCache::load() {
+    std::ifstream file(m_file_path);
+    if (!file.is_open())
+        throw std::runtime_error("ShapeCache::load: could not open " + m_file_path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty())
+            continue;
+        std::istringstream iss(line);
+        CachedDrawing drawing{};
+        size_t number_of_edges = 0;
+        iss >> drawing.graph_hash >> drawing.options_hash >> drawing.number_of_nodes >>
+            number_of_edges;
+        drawing.edges.resize(number_of_edges);
+        for (auto& [from, to] : drawing.edges)
+            iss >> from >> to;
+        size_t number_of_augmented_nodes = 0;
+        iss >> number_of_augmented_nodes;
+        for (size_t i = 0; i < number_of_augmented_nodes && iss; ++i) {
+            int color = 0;
+            int x = 0;
+            int y = 0;
+            iss >> color >> x >> y;
+            if (color < 0 || color > static_cast<int>(Color::ANY))
+                throw std::runtime_error("ShapeCache::load: invalid color in " + m_file_path);
+            drawing.colors.push_back(static_cast<Color>(color));
+            drawing.positions_x.push_back(x);
+            drawing.positions_y.push_back(y);
+        }
+        size_t number_of_augmented_edges = 0;
+        iss >> number_of_augmented_edges;
+        for (size_t i = 0; i < number_of_augmented_edges && iss; ++i) {
+            size_t from = 0;
+            size_t to = 0;
+            int direction = 0;
+            iss >> from >> to >> direction;
+            if (from >= number_of_augmented_nodes || to >= number_of_augmented_nodes)
+                throw std::runtime_error("ShapeCache::load: invalid edge in " + m_file_path);
+            if (direction < 0 || direction > static_cast<int>(Direction::DOWN))
+                throw std::runtime_error("ShapeCache::load: invalid direction in " + m_file_path);
+            drawing.augmented_edges.emplace_back(from, to);
+            drawing.directions.push_back(static_cast<Direction>(direction));
+        }
+        iss >> drawing.initial_number_of_cycles >> drawing.number_of_added_cycles >>
+            drawing.number_of_useless_bends;
+        if (!iss || drawing.number_of_nodes > number_of_augmented_nodes)
+            throw std::runtime_error("ShapeCache::load: invalid line in " + m_file_path);
+        // drawings saved before their time was kept are dropped, and computed again
+        if (!(iss >> drawing.time)) {
+            if (iss.eof())
+                continue;
+            throw std::runtime_error("ShapeCache::load: invalid line in " + m_file_path);
+        }
+        add_entry(std::move(drawing));
+    }
+}
+
+size_t ShapeCache::size() const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t ShapeCache::get_size_in_bytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_size_in_bytes;
+}
+
+size_t ShapeCache::get_number_of_hits() const {
+    std::lock_guard lock(m_mutex);
+    return m_number_of_hits;
+}
+
+size_t ShapeCache::get_number_of_misses() const {
+    std::lock_guard lock(m_mutex);
+    return m_number_of_misses;
+}
@@ -7,7 +7,7 @@
 #include "core/utils.hpp"
 #include "planarity/interlacement.hpp"
 
-Embedding merge_biconnected_components(const UndirectedSimpleGraph& graph,
+Embedding merge_biconnected_components(const CsrGraph& graph,
                                        const BiconnectedComponents& biconnected_components,
                                        const std::vector<Embedding>& embeddings) {
     Embedding output(graph);
@@ -30,6 +30,14 @@ Embedding base_case_graph(const UndirectedSimpleGraph& graph) {
     return embedding;
 }
 
+Embedding base_case_graph(const CsrGraph& graph) {
+    Embedding embedding(graph);
+    for (size_t node = 0; node < graph.size(); ++node)
+        for (const size_t neighbor : graph.get_neighbors(node))
+            embedding.add_edge(graph.get_node_id(node), graph.get_node_id(neighbor));
+    return embedding;
+}
+
 Embedding base_case_component(const UndirectedSimpleGraph& component, const Cycle& cycle) {
     Embedding embedding(component);
     for (const GraphNode* node : component.get_nodes()) {
@@ -390,6 +398,10 @@ std::optional<Embedding> embed_biconnected_component(const UndirectedSimpleGraph
 #include <iostream>
 
 std::optional<Embedding> embed_graph(const UndirectedSimpleGraph& graph) {
+    return embed_graph(CsrGraph(graph));
+}
+
+std::optional<Embedding> embed_graph(const CsrGraph& graph) {
     if (graph.size() < 4)
         return base_case_graph(graph);
     if (graph.get_number_of_edges() / 2 > 3 * graph.size() - 6)
@@ -405,4 +417,4 @@ std::optional<Embedding> embed_graph(const UndirectedSimpleGraph& graph) {
     }
     std::cout << "daje2\n";
     return merge_biconnected_components(graph, bic_comps, embeddings);
-}
\ No newline at end of file
+}
@@ -9,6 +9,11 @@ Embedding::Embedding(const UndirectedSimpleGraph& graph) {
         adjacency_list[node_id];
 }
 
+Embedding::Embedding(const CsrGraph& graph) {
+    for (const int node_id : graph.get_nodes_ids())
+        adjacency_list[node_id];
+}
+
 void Embedding::add_edge(const int from_id, const int to_id) {
     if (m_edges.contains({from_id, to_id}))
         throw std::runtime_error("Edge already exists");
@@ -1,5 +1,7 @@
 #include "planarity/interlacement.hpp"
 
+#include "core/graph/graph_builder.hpp"
+
 std::unordered_map<int, int> compute_cycle_labels(const Segment& segment, const Cycle& cycle) {
     std::unordered_map<int, int> cycle_labels;
     int found_attachments = 0;
@@ -17,7 +19,7 @@ std::unordered_map<int, int> compute_cycle_labels(const Segment& segment, const
 
 void compute_conflicts(const std::vector<Segment>& segments,
                        const Cycle& cycle,
-                       UndirectedSimpleGraph& interlacement_graph) {
+                       GraphBuilder& interlacement_graph) {
     if (segments.size() <= 1)
         return;
     for (size_t i = 0; i < segments.size() - 1; ++i) {
@@ -57,9 +59,9 @@ void compute_conflicts(const std::vector<Segment>& segments,
 
 std::unique_ptr<UndirectedSimpleGraph>
 compute_interlacement_graph(const std::vector<Segment>& segments, const Cycle& cycle) {
-    auto interlacement_graph = std::make_unique<UndirectedSimpleGraph>();
+    GraphBuilder interlacement_graph(segments.size(), 0);
     for (int i = 0; i < static_cast<int>(segments.size()); ++i)
-        interlacement_graph->add_node(i);
-    compute_conflicts(segments, cycle, *interlacement_graph);
-    return interlacement_graph;
+        interlacement_graph.add_node(i);
+    compute_conflicts(segments, cycle, interlacement_graph);
+    return interlacement_graph.finish();
 }
\ No newline at end of file
@@ -1,8 +1,16 @@
 #include "sat/kissat.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -12,15 +20,30 @@ extern "C" {
 #include "kissat/src/proof.h"
 }
 
+std::string sat_solver_result_type_to_string(const SatSolverResultType type) {
+    switch (type) {
+    case SatSolverResultType::SAT:
+        return "SAT";
+    case SatSolverResultType::UNSAT:
+        return "UNSAT";
+    case SatSolverResultType::UNKNOWN:
+        return "UNKNOWN";
+    }
+    throw std::runtime_error("Invalid sat solver result type");
+}
+
 std::string SatSolverResult::to_string() const {
-    std::string r = result == SatSolverResultType::SAT ? "SAT" : "UNSAT";
+    std::string r = sat_solver_result_type_to_string(result);
     std::string numbers_str = "Numbers: ";
     for (int num : numbers)
         numbers_str += std::to_string(num) + " ";
+    std::string units_str = "Unit clauses: ";
+    for (int unit : unit_clauses)
+        units_str += std::to_string(unit) + " ";
     std::string proof_str = "Proof:\n";
     for (const std::string& line : proof_lines)
         proof_str += line + "\n";
-    return r + "\n" + numbers_str + "\n" + proof_str;
+    return r + "\n" + numbers_str + "\n" + units_str + "\n" + proof_str;
 }
 
 void SatSolverResult::print() const { std::cout << to_string() << std::endl; }
@@ -42,10 +65,129 @@ struct MemoryFile {
     }
 };
 
+// reads a binary DRAT proof chunk by chunk and keeps the last added unit clauses,
+// every line is 'a' or 'd', then the literals as 7-bit varints of 2 * |lit| + (lit < 0),
+// then a 0 byte
+class BinaryProofUnitsParser {
+    size_t m_max_unit_clauses;
+    bool m_is_valid = true;
+    std::deque<int> m_unit_clauses;
+    size_t m_number_of_unit_clauses = 0;
+    bool m_is_inside_line = false;
+    bool m_is_addition = false;
+    size_t m_number_of_literals = 0;
+    int m_first_literal = 0;
+    unsigned m_value = 0;
+    unsigned m_shift = 0;
+    void end_line() {
+        m_is_inside_line = false;
+        if (!m_is_addition || m_number_of_literals != 1)
+            return;
+        m_number_of_unit_clauses++;
+        m_unit_clauses.push_back(m_first_literal);
+        if (m_max_unit_clauses != 0 && m_unit_clauses.size() > m_max_unit_clauses)
+            m_unit_clauses.pop_front();
+    }
+
+  public:
+    explicit BinaryProofUnitsParser(const size_t max_unit_clauses)
+        : m_max_unit_clauses(max_unit_clauses) {}
+    // does not throw, since it runs inside the stdio calls of kissat
+    void feed(const char* data, const size_t size) {
+        for (size_t i = 0; i < size && m_is_valid; ++i) {
+            const auto byte = static_cast<unsigned char>(data[i]);
+            if (!m_is_inside_line) {
+                if (byte != 'a' && byte != 'd') {
+                    m_is_valid = false;
+                    break;
+                }
+                m_is_inside_line = true;
+                m_is_addition = byte == 'a';
+                m_number_of_literals = 0;
+                continue;
+            }
+            if (byte == 0 && m_shift == 0) {
+                end_line();
+                continue;
+            }
+            m_value |= static_cast<unsigned>(byte & 0x7f) << m_shift;
+            if (byte & 0x80) {
+                m_shift += 7;
+                continue;
+            }
+            if (m_number_of_literals++ == 0) {
+                const auto variable = static_cast<int>(m_value >> 1);
+                m_first_literal = (m_value & 1) ? -variable : variable;
+            }
+            m_value = 0;
+            m_shift = 0;
+        }
+    }
+    [[nodiscard]] bool is_valid() const { return m_is_valid && !m_is_inside_line; }
+    [[nodiscard]] std::vector<int> get_unit_clauses() const {
+        return {m_unit_clauses.begin(), m_unit_clauses.end()};
+    }
+    [[nodiscard]] size_t get_number_of_unit_clauses() const { return m_number_of_unit_clauses; }
+};
+
+// the proof is parsed while kissat writes it, so it is never stored
+// (open_memstream is used instead where fopencookie is not available)
+#ifdef __GLIBC__
+struct BinaryProofStream {
+    FILE* stream = NULL;
+    explicit BinaryProofStream(BinaryProofUnitsParser& parser) {
+        cookie_io_functions_t functions{};
+        functions.write = [](void* cookie, const char* data, size_t size) -> ssize_t {
+            static_cast<BinaryProofUnitsParser*>(cookie)->feed(data, size);
+            return static_cast<ssize_t>(size);
+        };
+        stream = fopencookie(&parser, "w", functions);
+        if (!stream) {
+            perror("fopencookie");
+            throw std::runtime_error("Failed to initialize BinaryProofStream");
+        }
+    }
+    ~BinaryProofStream() { fclose(stream); }
+    void finish() { fflush(stream); }
+};
+#else
+struct BinaryProofStream {
+    BinaryProofUnitsParser& parser;
+    MemoryFile memory_file;
+    FILE* stream = NULL;
+    explicit BinaryProofStream(BinaryProofUnitsParser& units_parser)
+        : parser(units_parser), stream(memory_file.mem) {}
+    void finish() {
+        fflush(stream);
+        parser.feed(memory_file.buffer, memory_file.size);
+    }
+};
+#endif
+
 class KissatSolver {
   private:
     kissat* solver = nullptr;
     std::string proof{};
+    std::chrono::steady_clock::time_point deadline{};
+
+    static int is_deadline_passed(void* state) {
+        const auto* kissat_solver = static_cast<const KissatSolver*>(state);
+        return std::chrono::steady_clock::now() >= kissat_solver->deadline;
+    }
+
+    int run_with_proof(FILE* stream, const bool binary) {
+        file proof_file;
+        proof_file.file = stream;
+        proof_file.close = true;
+        proof_file.reading = false;
+        proof_file.compressed = false;
+        proof_file.path = NULL;
+        proof_file.bytes = 0;
+        kissat_init_proof(solver, &proof_file, binary);
+        const int res = kissat_solve(solver);
+        kissat_release_proof(solver);
+        return res;
+    }
 
   public:
     KissatSolver() {
@@ -59,30 +201,64 @@ class KissatSolver {
             kissat_release(solver);
     }
 
+    // the time limit starts counting from here
+    void set_limits(const SatSolverOptions& options) {
+        if (options.conflict_limit != 0)
+            kissat_set_conflict_limit(solver, options.conflict_limit);
+        if (options.decision_limit != 0)
+            kissat_set_decision_limit(solver, options.decision_limit);
+        if (options.time_limit.count() != 0) {
+            deadline = std::chrono::steady_clock::now() + options.time_limit;
+            kissat_set_terminate(solver, this, &KissatSolver::is_deadline_passed);
+        }
+    }
+
+    // instance 0 keeps the default configuration, the others go through the configurations
+    // tuned for satisfiable and unsatisfiable formulas, with different seeds, and flip the
+    // initial phase once all configurations have been used
+    void configure(const size_t portfolio_index) {
+        if (portfolio_index == 0)
+            return;
+        static constexpr std::array configurations = {"sat", "unsat", "plain", "default"};
+        const size_t index = portfolio_index - 1;
+        kissat_set_configuration(solver, configurations[index % configurations.size()]);
+        kissat_set_option(solver, "seed", static_cast<int>(portfolio_index));
+        kissat_set_option(solver, "phase", (index / configurations.size()) % 2 == 0 ? 1 : 0);
+    }
+
+    // can be called from another thread while solving
+    void terminate() { kissat_terminate(solver); }
+
     void add_clause(const std::vector<int>& clause) {
         for (int lit : clause)
             kissat_add(solver, lit);
         kissat_add(solver, 0); // terminate clause
     }
 
-    bool solve() {
-        file proof_file;
+    SatSolverResultType solve() {
         MemoryFile memory_file;
-        proof_file.file = memory_file.mem;
-        proof_file.close = true;
-        proof_file.reading = false;
-        proof_file.compressed = false;
-        proof_file.path = NULL;
-        proof_file.bytes = 0;
-        kissat_init_proof(solver, &proof_file, false);
-        int res = kissat_solve(solver);
-        kissat_release_proof(solver);
+        const int res = run_with_proof(memory_file.mem, false);
         proof = memory_file.buffer;
+        return interpret_result(res);
+    }
+
+    SatSolverResultType solve_without_proof() { return interpret_result(kissat_solve(solver)); }
+
+    SatSolverResultType solve(BinaryProofUnitsParser& parser) {
+        BinaryProofStream proof_stream(parser);
+        const int res = run_with_proof(proof_stream.stream, true);
+        proof_stream.finish();
+        return interpret_result(res);
+    }
+
+    static SatSolverResultType interpret_result(const int res) {
         if (res == 10)
-            return true;
+            return SatSolverResultType::SAT;
         if (res == 20)
-            return false;
-        throw std::runtime_error("Solver returned UNKNOWN");
+            return SatSolverResultType::UNSAT;
+        if (res == 0)
+            return SatSolverResultType::UNKNOWN;
+        throw std::runtime_error("Solver returned an invalid result");
     }
 
     bool value(int lit) const { return kissat_value(solver, lit) > 0; }
@@ -90,28 +266,130 @@ class KissatSolver {
     const std::string& get_proof() const { return proof; }
 };
 
-SatSolverResult launch_kissat(const Cnf& cnf) {
+// unit clauses added in a text proof, in order
+void collect_unit_clauses(const std::vector<std::string>& proof_lines,
+                          const SatSolverOptions& options,
+                          SatSolverResult& result) {
+    for (const std::string& line : proof_lines) {
+        if (line.empty() || line[0] == 'd')
+            continue;
+        std::istringstream iss(line);
+        int literal = 0;
+        int terminator = 1;
+        if (!(iss >> literal >> terminator) || terminator != 0)
+            continue;
+        result.number_of_unit_clauses++;
+        result.unit_clauses.push_back(literal);
+    }
+    const size_t max = options.max_unit_clauses;
+    if (max != 0 && result.unit_clauses.size() > max)
+        result.unit_clauses.erase(result.unit_clauses.begin(),
+                                  result.unit_clauses.end() - static_cast<std::ptrdiff_t>(max));
+}
+
+SatSolverResult launch_kissat(const Cnf& cnf, const SatSolverOptions& options) {
+    return launch_kissat(std::vector{&cnf}, options);
+}
+
+// one instance of the portfolio
+struct SolverRun {
     KissatSolver solver;
-    for (const CnfRow& row : cnf.get_rows())
-        if (row.m_type == CnfRowType::CLAUSE)
-            solver.add_clause(row.m_clause);
-    const bool is_sat = solver.solve();
+    BinaryProofUnitsParser parser;
+    SatSolverResultType type = SatSolverResultType::UNKNOWN;
+    explicit SolverRun(const size_t max_unit_clauses) : parser(max_unit_clauses) {}
+};
+
+void run_solver(SolverRun& run,
+                const std::vector<const Cnf*>& cnfs,
+                const SatSolverOptions& options) {
+    for (const Cnf* cnf : cnfs)
+        for (const CnfRow& row : cnf->get_rows())
+            if (row.m_type == CnfRowType::CLAUSE)
+                run.solver.add_clause(row.m_clause);
+    if (!options.produce_proof)
+        run.type = run.solver.solve_without_proof();
+    else
+        run.type = options.binary_proof ? run.solver.solve(run.parser) : run.solver.solve();
+}
+
+SatSolverResult make_result(const SolverRun& run,
+                            const SatSolverOptions& options,
+                            const int number_of_variables) {
     SatSolverResult result;
-    if (is_sat) {
-        result.result = SatSolverResultType::SAT;
-        for (int var = 1; var <= cnf.get_number_of_variables(); ++var) {
-            if (solver.value(var))
+    result.result = run.type;
+    if (run.type == SatSolverResultType::SAT) {
+        for (int var = 1; var <= number_of_variables; ++var) {
+            if (run.solver.value(var))
                 result.numbers.push_back(var);
             else
                 result.numbers.push_back(-var);
         }
+    }
+    if (run.type != SatSolverResultType::UNSAT || !options.produce_proof)
+        return result;
+    if (options.binary_proof) {
+        if (!run.parser.is_valid())
+            throw std::runtime_error("Invalid binary proof");
+        result.unit_clauses = run.parser.get_unit_clauses();
+        result.number_of_unit_clauses = run.parser.get_number_of_unit_clauses();
     } else {
-        result.result = SatSolverResultType::UNSAT;
-        const std::string proof_str = solver.get_proof();
+        const std::string proof_str = run.solver.get_proof();
         std::istringstream iss(proof_str);
         std::string line;
         while (std::getline(iss, line))
             result.proof_lines.push_back(line);
+        collect_unit_clauses(result.proof_lines, options, result);
     }
     return result;
-}
\ No newline at end of file
+}
+
+// all the instances are created before any thread starts, and released after all of them
+// joined, so that the winner can safely terminate the others
+SatSolverResult launch_kissat(const std::vector<const Cnf*>& cnfs,
+                              const SatSolverOptions& options) {
+#ifdef __EMSCRIPTEN__
+    const size_t portfolio_size = 1;
+#else
+    const size_t portfolio_size = std::max(options.portfolio_size, static_cast<size_t>(1));
+#endif
+    std::vector<std::unique_ptr<SolverRun>> runs;
+    for (size_t i = 0; i < portfolio_size; ++i) {
+        runs.push_back(std::make_unique<SolverRun>(options.max_unit_clauses));
+        runs.back()->solver.configure(i);
+        runs.back()->solver.set_limits(options);
+    }
+    int number_of_variables = 0;
+    for (const Cnf* cnf : cnfs)
+        number_of_variables = std::max(number_of_variables, cnf->get_number_of_variables());
+    if (portfolio_size == 1) {
+        run_solver(*runs[0], cnfs, options);
+        return make_result(*runs[0], options, number_of_variables);
+    }
+    std::atomic<bool> has_winner = false;
+    size_t winner = 0;
+    std::vector<std::exception_ptr> errors(portfolio_size);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < portfolio_size; ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                run_solver(*runs[i], cnfs, options);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                return;
+            }
+            if (runs[i]->type == SatSolverResultType::UNKNOWN || has_winner.exchange(true))
+                return;
+            winner = i;
+            for (size_t j = 0; j < portfolio_size; ++j)
+                if (j != i)
+                    runs[j]->solver.terminate();
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (!has_winner)
+        for (const std::exception_ptr& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    return make_result(*runs[winner], options, number_of_variables);
+}
@@ -5,6 +5,9 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <unordered_set>
 #include <vector>
@@ -16,16 +19,61 @@
 #include "core/graph/graphs_algorithms.hpp"
 #include "orthogonal/drawing_builder.hpp"
 #include "orthogonal/drawing_stats.hpp"
+#include "orthogonal/drawing_store.hpp"
+#include "orthogonal/shape_cache.hpp"
 
 std::unordered_set<std::string> graphs_already_in_csv;
 int total_fails = 0;
 std::mutex input_output_lock;
 std::mutex write_lock;
+// drawings of earlier runs, only if shape_cache_file is in the config
+std::unique_ptr<ShapeCache> shape_cache;
+constexpr size_t SHAPE_CACHE_MAX_BYTES = 512 * 1024 * 1024;
+// drawings addressed by the content of their graph file and the drawing settings (see
+// compute_drawing_store_key), only if drawing_store_folder is in the config, a graph already there
+// is not drawn again
+std::unique_ptr<DrawingStore> drawing_store;
+// new drawings are compacted again with AreaCompaction::NETWORK_SIMPLEX, only if
+// network_simplex_compaction=true is in the config
+bool network_simplex_compaction = false;
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open file " + path);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// key of the graph file in the drawing store: its content together with everything else that
+// changes the drawing (the options and the compaction after drawing), so that a store filled with
+// other settings is not read back
+uint64_t compute_drawing_store_key(const std::string& path) {
+    const uint64_t options_hash = hash_drawing_options(DrawingOptions{});
+    return fnv1a_hash(read_file(path) + "\n" + std::to_string(options_hash) + " " +
+                      std::to_string(network_simplex_compaction));
+}
 
 auto test_shape_metrics_approach(const UndirectedSimpleGraph& graph,
                                  const std::filesystem::path& svg_output_filename) {
+    // a cached drawing comes with the time of its original computation
+    if (shape_cache) {
+        StoredDrawing drawing = shape_cache->make_orthogonal_drawing(graph);
+        if (network_simplex_compaction) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            compact_drawing(drawing.result, AreaCompaction::NETWORK_SIMPLEX);
+            const std::chrono::duration<double> elapsed =
+                std::chrono::high_resolution_clock::now() - start;
+            drawing.time += elapsed.count();
+        }
+        make_svg(*drawing.result.augmented_graph, drawing.result.attributes, svg_output_filename);
+        return std::make_pair(std::move(drawing.result), drawing.time);
+    }
     const auto start = std::chrono::high_resolution_clock::now();
     DrawingResult result = make_orthogonal_drawing(graph);
+    if (network_simplex_compaction)
+        compact_drawing(result, AreaCompaction::NETWORK_SIMPLEX);
     const auto end = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double> elapsed = end - start;
     make_svg(*result.augmented_graph, result.attributes, svg_output_filename);
@@ -75,7 +123,22 @@ void make_stats_of_graphs_in_folder(const std::string& folder_path,
                     number_of_drawings_computed.fetch_add(1, std::memory_order_relaxed);
                 if (graphs_already_in_csv.contains(graph_filename))
                     continue;
-                std::unique_ptr<UndirectedSimpleGraph> graph = load_graph_from_txt_file(entry_path);
+                std::filesystem::path svg_output_path =
+                    std::filesystem::path(output_svgs_folder) / (graph_filename + ".svg");
+                uint64_t graph_key = 0;
+                if (drawing_store) {
+                    graph_key = compute_drawing_store_key(entry_path);
+                    const std::optional<StoredDrawing> stored = drawing_store->find(graph_key);
+                    if (stored.has_value()) {
+                        make_svg(*stored->result.augmented_graph,
+                                 stored->result.attributes,
+                                 svg_output_path);
+                        save_stats(results_file, stored->result, stored->time, graph_filename);
+                        continue;
+                    }
+                }
+                std::unique_ptr<UndirectedSimpleGraph> graph =
+                    load_graph_from_mapped_txt_file(entry_path);
                 if (!is_graph_connected(*graph)) {
                     std::lock_guard<std::mutex> lock(input_output_lock);
                     std::cerr << "Graph " << graph_filename << " is not connected, skipping."
@@ -88,10 +151,10 @@ void make_stats_of_graphs_in_folder(const std::string& folder_path,
                     std::cout << "Processing comparison #" << current_number << " - "
                               << graph_filename << std::endl;
                 }
-                std::filesystem::path svg_output_path =
-                    std::filesystem::path(output_svgs_folder) / (graph_filename + ".svg");
                 try {
                     const auto result = test_shape_metrics_approach(*graph, svg_output_path);
+                    if (drawing_store)
+                        drawing_store->insert(graph_key, result.first, result.second);
                     save_stats(results_file, result.first, result.second, graph_filename);
                 } catch (const std::exception& e) {
                     std::lock_guard<std::mutex> lock(input_output_lock);
@@ -161,8 +224,19 @@ void make_stats(const Config& config) {
             std::cerr << "Error: Could not create directory " << output_svgs_folder << std::endl;
             return;
         }
+    if (config.has("drawing_store_folder"))
+        drawing_store = std::make_unique<DrawingStore>(config.get("drawing_store_folder"));
+    if (config.has("shape_cache_file"))
+        shape_cache =
+            std::make_unique<ShapeCache>(SHAPE_CACHE_MAX_BYTES, config.get("shape_cache_file"));
+    network_simplex_compaction = config.has("network_simplex_compaction") &&
+                                 config.get("network_simplex_compaction") == "true";
     std::string test_graphs_folder = config.get("test_graphs_folder");
     make_stats_of_graphs_in_folder(test_graphs_folder, result_file, output_svgs_folder);
+    if (shape_cache) {
+        shape_cache->save();
+        std::cout << "Shape cache hits: " << shape_cache->get_number_of_hits() << std::endl;
+    }
     std::cout << std::endl;
     result_file.close();
 }